@@ -1,20 +1,11 @@
-# TEMPLATE = app
-# CONFIG += console c++17
-# CONFIG -= app_bundle
-# CONFIG -= qt
+# Proyecto principal: la biblioteca de reconstruccion (libdesafio) y la aplicacion de
+# linea de comandos, que la enlaza. El generador, los benchmarks y las pruebas se
+# compilan aparte.
 
-# SOURCES += \
-#         main.cpp
+TEMPLATE = subdirs
 
+SUBDIRS += \
+    libdesafio \
+    aplicacion
 
-QT += core gui
-CONFIG += console c++17
-SOURCES += main.cpp \
-    operaciones.cpp \
-    procesamiento.cpp \
-    validacion.cpp
-
-HEADERS += \
-    operaciones.h \
-    procesamiento.h \
-    validacion.h
+aplicacion.depends = libdesafio
@@ -0,0 +1,56 @@
+# Aplicacion de linea de comandos: lectura y escritura de archivos, lotes, puntos de
+# control y modo servidor sobre la biblioteca de reconstruccion (libdesafio), que
+# enlaza en lugar de compilar sus fuentes. Se compila desde BETA2.pro.
+
+QT += core gui
+CONFIG += console c++17
+CONFIG(release, debug|release): DEFINES += DESAFIO_SIN_DEPURACION
+TARGET = BETA2
+
+# La aplicacion usa tambien funciones internas de la biblioteca que la version
+# compartida no exporta: siempre enlaza la estatica
+desafio_compartida: error("aplicacion.pro enlaza libdesafio estatica; la compartida se compila aparte con libdesafio.pro")
+
+INCLUDEPATH += ..
+
+SOURCES += ../main.cpp \
+    ../bmp.cpp \
+    ../exportacion.cpp \
+    ../memoria_operadores.cpp \
+    ../procesamiento.cpp \
+    ../reanudacion.cpp \
+    ../recursos.cpp \
+    ../servidor.cpp
+
+HEADERS += \
+    ../bmp.h \
+    ../desafio.h \
+    ../exportacion.h \
+    ../hilos.h \
+    ../imagen.h \
+    ../memoria.h \
+    ../operaciones.h \
+    ../operaciones_paralelas.h \
+    ../operaciones_simd.h \
+    ../planificacion.h \
+    ../procesamiento.h \
+    ../reanudacion.h \
+    ../recursos.h \
+    ../registro.h \
+    ../servidor.h \
+    ../traza.h \
+    ../validacion.h
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../libdesafio/release/ -ldesafio
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../libdesafio/debug/ -ldesafio
+else:unix: LIBS += -L$$OUT_PWD/../libdesafio/ -ldesafio
+
+# Volver a enlazar cuando cambia la biblioteca
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../libdesafio/release/libdesafio.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../libdesafio/debug/libdesafio.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../libdesafio/release/desafio.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../libdesafio/debug/desafio.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../libdesafio/libdesafio.a
+
+# Pico de memoria residente en Windows (ver memoria.cpp); despues de la biblioteca
+win32: LIBS += -lpsapi
@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include "operaciones.h"
+#include "operaciones_paralelas.h"
+#include "operaciones_simd.h"
+#include "registro.h"
+#include "validacion.h"
+
+using namespace std;
+
+// Tamaños de imagen medidos, de miniatura a 100 MP
+struct TamanoImagen {
+    const char* nombre;
+    int ancho;
+    int alto;
+};
+
+static const TamanoImagen TAMANOS[] = {
+    { "160x120",     160,   120 },
+    { "640x480",     640,   480 },
+    { "1920x1080",  1920,  1080 },
+    { "4000x3000",  4000,  3000 },
+    { "10000x10000", 10000, 10000 },
+};
+
+struct OpcionesBenchmark {
+    int calentamiento = 2;         // repeticiones descartadas antes de medir
+    int repeticiones = 7;          // repeticiones medidas (se informa la mediana)
+    double msPorRepeticion = 50.0; // duracion minima de cada repeticion
+    double maxMegapixeles = 100.0; // omitir tamaños mayores
+    double tolerancia = 10.0;      // % de empeoramiento permitido al comparar
+    QString guardar;               // JSON donde guardar los resultados
+    QString comparar;              // JSON de referencia
+};
+
+struct ResultadoBenchmark {
+    string kernel;
+    string tamano;
+    double bytes;      // bytes procesados por llamada
+    double nsPorByte;  // mediana
+    double nsMinimo;   // mejor repeticion
+    double gbPorSeg;   // a partir de la mediana
+};
+
+// Buffers de un tamaño de imagen, compartidos por todos los nucleos
+struct DatosBenchmark {
+    int ancho = 0;
+    int alto = 0;
+    size_t bytes = 0;
+    vector<unsigned char> img;
+    vector<unsigned char> im;
+    vector<unsigned char> destino;
+    vector<unsigned char> mascara;
+    vector<unsigned int> datosSuma;     // img + mascara
+    vector<unsigned int> datosRotacion; // rotl3(img) + mascara
+};
+
+static void prepararDatos(DatosBenchmark& datos, int ancho, int alto) {
+    datos.ancho = ancho;
+    datos.alto = alto;
+    datos.bytes = (size_t)ancho * alto * 3;
+    datos.img.resize(datos.bytes);
+    datos.im.resize(datos.bytes);
+    datos.destino.resize(datos.bytes);
+    datos.mascara.resize(datos.bytes);
+    datos.datosSuma.resize(datos.bytes);
+    datos.datosRotacion.resize(datos.bytes);
+
+    // Generador simple y determinista: los resultados no dependen de la corrida
+    unsigned int estado = 12345;
+    for (size_t i = 0; i < datos.bytes; i++) {
+        estado = estado * 1103515245u + 12345u;
+        datos.img[i] = (unsigned char)(estado >> 24);
+        datos.im[i] = (unsigned char)(estado >> 16);
+        datos.mascara[i] = (unsigned char)(estado >> 8);
+        datos.datosSuma[i] = datos.img[i] + datos.mascara[i];
+        datos.datosRotacion[i] = AplicarOperacionByte(datos.img[i], 0, 23) + datos.mascara[i];
+    }
+}
+
+/**
+ * @brief Mide una funcion y devuelve la mediana y el minimo en ns por byte.
+ *
+ * Primero calibra cuantas llamadas caben en `msPorRepeticion`, luego descarta
+ * `calentamiento` repeticiones y mide `repeticiones` mas.
+ */
+static void medir(const function<void()>& funcion, double bytes, const OpcionesBenchmark& opciones, double& mediana, double& minimo) {
+    typedef chrono::steady_clock Reloj;
+
+    long long iteraciones = 1;
+    while (true) {
+        Reloj::time_point inicio = Reloj::now();
+        for (long long i = 0; i < iteraciones; i++) funcion();
+        double ms = chrono::duration<double, milli>(Reloj::now() - inicio).count();
+        if (ms >= opciones.msPorRepeticion / 4 || iteraciones >= (1LL << 30)) {
+            double escala = ms > 0 ? opciones.msPorRepeticion / ms : 2.0;
+            iteraciones = max(1LL, (long long)(iteraciones * escala));
+            break;
+        }
+        iteraciones *= 4;
+    }
+
+    vector<double> tiempos;
+    for (int r = 0; r < opciones.calentamiento + opciones.repeticiones; r++) {
+        Reloj::time_point inicio = Reloj::now();
+        for (long long i = 0; i < iteraciones; i++) funcion();
+        double ns = chrono::duration<double, nano>(Reloj::now() - inicio).count();
+        if (r >= opciones.calentamiento) {
+            tiempos.push_back(ns / (iteraciones * bytes));
+        }
+    }
+
+    sort(tiempos.begin(), tiempos.end());
+    mediana = tiempos[tiempos.size() / 2];
+    minimo = tiempos.front();
+}
+
+static void registrarResultado(vector<ResultadoBenchmark>& resultados, const string& kernel, const TamanoImagen& tamano,
+                               double bytes, const function<void()>& funcion, const OpcionesBenchmark& opciones) {
+    ResultadoBenchmark r;
+    r.kernel = kernel;
+    r.tamano = tamano.nombre;
+    r.bytes = bytes;
+    medir(funcion, bytes, opciones, r.nsPorByte, r.nsMinimo);
+    r.gbPorSeg = 1.0 / r.nsPorByte; // 1 byte/ns = 1 GB/s
+
+    char linea[160];
+    snprintf(linea, sizeof(linea), "%-24s %-12s %14.0f %10.4f %10.4f %9.2f",
+             r.kernel.c_str(), r.tamano.c_str(), r.bytes, r.nsPorByte, r.nsMinimo, r.gbPorSeg);
+    cout << linea << endl;
+    resultados.push_back(r);
+}
+
+/**
+ * @brief Mide todos los nucleos para un tamaño de imagen.
+ *
+ * Los nucleos de imagen procesan la imagen completa; los de validacion usan una
+ * mascara del mismo tamaño que la imagen, de modo que recorren todos los bytes.
+ */
+static void medirTamano(const TamanoImagen& tamano, const OpcionesBenchmark& opciones, vector<ResultadoBenchmark>& resultados) {
+    DatosBenchmark datos;
+    prepararDatos(datos, tamano.ancho, tamano.alto);
+
+    unsigned char* img = datos.img.data();
+    unsigned char* im = datos.im.data();
+    unsigned char* destino = datos.destino.data();
+    unsigned char* mascara = datos.mascara.data();
+    int ancho = datos.ancho, alto = datos.alto;
+    int numPixeles = ancho * alto;
+    double bytes = (double)datos.bytes;
+
+    registrarResultado(resultados, "DoXOR", tamano, bytes, [&] {
+        DoXOR(img, im, destino, ancho, alto);
+    }, opciones);
+    registrarResultado(resultados, "RotarDerecha", tamano, bytes, [&] {
+        RotarDerecha(img, destino, numPixeles, 3);
+    }, opciones);
+    registrarResultado(resultados, "RotarIzquierda", tamano, bytes, [&] {
+        RotarIzquierda(img, destino, numPixeles, 3);
+    }, opciones);
+    registrarResultado(resultados, "SumarMascara", tamano, bytes, [&] {
+        SumarMascara(img, mascara, destino, ancho, alto, ancho, alto, 0);
+    }, opciones);
+
+    // Los mismos nucleos repartidos en bandas sobre el pool de hilos
+    registrarResultado(resultados, "DoXORParalelo", tamano, bytes, [&] {
+        DoXORParalelo(img, im, destino, ancho, alto);
+    }, opciones);
+    registrarResultado(resultados, "RotarIzquierdaParalelo", tamano, bytes, [&] {
+        RotarIzquierdaParalelo(img, destino, numPixeles, 3);
+    }, opciones);
+    registrarResultado(resultados, "SumarMascaraParalelo", tamano, bytes, [&] {
+        SumarMascaraParalelo(img, mascara, destino, ancho, alto, ancho, alto, 0);
+    }, opciones);
+
+    registrarResultado(resultados, "ValidarSumaMascara", tamano, bytes, [&] {
+        ValidarSumaMascara(img, mascara, datos.datosSuma.data(), 0, ancho, alto, ancho, alto);
+    }, opciones);
+    registrarResultado(resultados, "ValidarVentanaOperacion", tamano, bytes, [&] {
+        ValidarVentanaOperacion(img, nullptr, mascara, datos.datosRotacion.data(), 0, ancho, alto, ancho, alto, 23);
+    }, opciones);
+    registrarResultado(resultados, "DetectarOperacion", tamano, bytes, [&] {
+        DetectarOperacionUnaPasada(img, im, mascara, datos.datosRotacion.data(), 0, ancho, alto, ancho, alto);
+    }, opciones);
+    registrarResultado(resultados, "DigestoBytes", tamano, bytes, [&] {
+        DigestoBytes(img, datos.bytes);
+    }, opciones);
+}
+
+static bool guardarResultados(const QString& ruta, const vector<ResultadoBenchmark>& resultados) {
+    QJsonArray lista;
+    for (const ResultadoBenchmark& r : resultados) {
+        QJsonObject objeto;
+        objeto["kernel"] = QString::fromStdString(r.kernel);
+        objeto["tamano"] = QString::fromStdString(r.tamano);
+        objeto["bytes"] = r.bytes;
+        objeto["ns_por_byte"] = r.nsPorByte;
+        objeto["ns_por_byte_min"] = r.nsMinimo;
+        objeto["gb_por_s"] = r.gbPorSeg;
+        lista.append(objeto);
+    }
+
+    QJsonObject raiz;
+    raiz["variante"] = QString(KernelsActivos().nombre);
+    raiz["resultados"] = lista;
+
+    QSaveFile archivo(ruta);
+    if (!archivo.open(QIODevice::WriteOnly)) return false;
+    archivo.write(QJsonDocument(raiz).toJson());
+    return archivo.commit();
+}
+
+/**
+ * @brief Compara los resultados con una referencia guardada con `--guardar`.
+ *
+ * @return int Numero de mediciones que empeoraron mas que la tolerancia (-1 si no se pudo leer la referencia).
+ */
+static int compararResultados(const QString& ruta, const vector<ResultadoBenchmark>& resultados, double tolerancia) {
+    QFile archivo(ruta);
+    if (!archivo.open(QIODevice::ReadOnly)) {
+        cerr << "No se pudo abrir la referencia " << ruta.toStdString() << endl;
+        return -1;
+    }
+    QJsonDocument documento = QJsonDocument::fromJson(archivo.readAll());
+    if (!documento.isObject()) {
+        cerr << "La referencia " << ruta.toStdString() << " no es un JSON valido" << endl;
+        return -1;
+    }
+    QJsonObject raiz = documento.object();
+    QJsonArray lista = raiz["resultados"].toArray();
+
+    cout << "\nComparacion con " << ruta.toStdString()
+         << " (variante " << raiz["variante"].toString().toStdString() << ", tolerancia " << tolerancia << "%)" << endl;
+
+    int regresiones = 0;
+    for (const ResultadoBenchmark& r : resultados) {
+        double referencia = 0;
+        for (const QJsonValue& valor : lista) {
+            QJsonObject objeto = valor.toObject();
+            if (objeto["kernel"].toString().toStdString() == r.kernel && objeto["tamano"].toString().toStdString() == r.tamano) {
+                referencia = objeto["ns_por_byte"].toDouble();
+                break;
+            }
+        }
+        if (referencia <= 0) continue;
+
+        double cambio = (r.nsPorByte / referencia - 1.0) * 100.0;
+        bool regresion = cambio > tolerancia;
+        if (regresion) regresiones++;
+
+        char linea[160];
+        snprintf(linea, sizeof(linea), "%-24s %-12s %10.4f -> %10.4f ns/byte %+8.1f%%%s",
+                 r.kernel.c_str(), r.tamano.c_str(), referencia, r.nsPorByte, cambio, regresion ? "  REGRESION" : "");
+        cout << linea << endl;
+    }
+    return regresiones;
+}
+
+static void mostrarUso(const char* programa) {
+    cout << "Uso: " << programa << " [opciones]" << endl;
+    cout << "  --variante NOMBRE     Nucleos a medir: escalar, sse2, avx2 o avx512 (por defecto el mejor)" << endl;
+    cout << "  --max-mp N            Omitir imagenes de mas de N megapixeles (por defecto 100)" << endl;
+    cout << "  --repeticiones N      Repeticiones medidas por caso (por defecto 7)" << endl;
+    cout << "  --calentamiento N     Repeticiones descartadas antes de medir (por defecto 2)" << endl;
+    cout << "  --ms N                Duracion minima de cada repeticion en ms (por defecto 50)" << endl;
+    cout << "  --guardar ARCHIVO     Guardar los resultados como JSON" << endl;
+    cout << "  --comparar ARCHIVO    Comparar con un JSON guardado antes y fallar si hay regresiones" << endl;
+    cout << "  --tolerancia N        Porcentaje de empeoramiento permitido (por defecto 10)" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    OpcionesBenchmark opciones;
+
+    // Los mensajes de depuracion de las validaciones no deben medirse
+    EstablecerNivelRegistro(NIVEL_ERROR);
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool conValor = i + 1 < argc;
+        if (arg == "--variante" && conValor) {
+            if (!SeleccionarKernels(argv[++i])) {
+                cerr << "Variante no disponible en esta CPU: " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--max-mp" && conValor) {
+            opciones.maxMegapixeles = atof(argv[++i]);
+        } else if (arg == "--repeticiones" && conValor) {
+            opciones.repeticiones = max(1, atoi(argv[++i]));
+        } else if (arg == "--calentamiento" && conValor) {
+            opciones.calentamiento = max(0, atoi(argv[++i]));
+        } else if (arg == "--ms" && conValor) {
+            opciones.msPorRepeticion = max(1.0, atof(argv[++i]));
+        } else if (arg == "--guardar" && conValor) {
+            opciones.guardar = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--comparar" && conValor) {
+            opciones.comparar = QString::fromLocal8Bit(argv[++i]);
+        } else if (arg == "--tolerancia" && conValor) {
+            opciones.tolerancia = atof(argv[++i]);
+        } else {
+            mostrarUso(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    cout << "Variante de nucleos: " << KernelsActivos().nombre << endl;
+    char encabezado[160];
+    snprintf(encabezado, sizeof(encabezado), "%-24s %-12s %14s %10s %10s %9s",
+             "kernel", "tamano", "bytes", "ns/byte", "min", "GB/s");
+    cout << encabezado << endl;
+
+    vector<ResultadoBenchmark> resultados;
+    for (const TamanoImagen& tamano : TAMANOS) {
+        if ((double)tamano.ancho * tamano.alto / 1e6 > opciones.maxMegapixeles) continue;
+        medirTamano(tamano, opciones, resultados);
+    }
+
+    if (!opciones.guardar.isEmpty()) {
+        if (guardarResultados(opciones.guardar, resultados)) {
+            cout << "Resultados guardados en " << opciones.guardar.toStdString() << endl;
+        } else {
+            cerr << "No se pudieron guardar los resultados en " << opciones.guardar.toStdString() << endl;
+            return 1;
+        }
+    }
+
+    if (!opciones.comparar.isEmpty()) {
+        int regresiones = compararResultados(opciones.comparar, resultados, opciones.tolerancia);
+        if (regresiones != 0) {
+            if (regresiones > 0) cerr << regresiones << " regresiones de rendimiento" << endl;
+            return 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+# Microbenchmarks de los nucleos de operaciones y validacion.
+# Se compila aparte de BETA2.pro para no mezclarlo con la aplicacion.
+
+QT += core
+QT -= gui
+CONFIG += console c++17 release
+CONFIG -= app_bundle debug
+DEFINES += DESAFIO_SIN_DEPURACION
+win32: LIBS += -lpsapi
+TARGET = benchmarks
+
+INCLUDEPATH += ..
+
+SOURCES += benchmarks.cpp \
+    ../hilos.cpp \
+    ../imagen.cpp \
+    ../memoria.cpp \
+    ../operaciones.cpp \
+    ../operaciones_paralelas.cpp \
+    ../operaciones_simd.cpp \
+    ../registro.cpp \
+    ../traza.cpp \
+    ../validacion.cpp
+
+HEADERS += \
+    ../hilos.h \
+    ../imagen.h \
+    ../memoria.h \
+    ../operaciones.h \
+    ../operaciones_paralelas.h \
+    ../operaciones_simd.h \
+    ../registro.h \
+    ../traza.h \
+    ../validacion.h
@@ -0,0 +1,290 @@
+#include "bmp.h"
+#include <QtEndian>
+#include <cstdint>
+#include <cstring>
+
+// Cabecera de archivo (14 bytes) + BITMAPINFOHEADER (40 bytes)
+static const qint64 TAM_CABECERA_BMP = 54;
+
+static qint64 strideBMP(int ancho) {
+    return ((qint64)ancho * 3 + 3) & ~(qint64)3;
+}
+
+/**
+ * @brief Mapea un BMP de 24 bits sin compresion y devuelve una vista de sus pixeles.
+ *
+ * No copia ni decodifica nada: la vista apunta directamente al archivo mapeado y es
+ * valida mientras `archivo` siga abierto.
+ *
+ * @param ruta Ruta del archivo BMP.
+ * @param archivo Archivo que mantiene el mapeo vivo.
+ * @param vista Vista resultante con dimensiones, stride y orden de filas.
+ * @return false Si el archivo no existe o no es un BMP de 24 bits sin compresion.
+ */
+
+bool AbrirBMP(const QString& ruta, QFile& archivo, VistaBMP& vista) {
+    archivo.setFileName(ruta);
+    if (!archivo.open(QIODevice::ReadOnly)) return false;
+
+    qint64 tam = archivo.size();
+    if (tam < TAM_CABECERA_BMP) return false;
+
+    const uchar* datos = archivo.map(0, tam);
+    if (!datos || datos[0] != 'B' || datos[1] != 'M') return false;
+
+    quint32 inicioPixeles = qFromLittleEndian<quint32>(datos + 10);
+    quint32 tamInfo = qFromLittleEndian<quint32>(datos + 14);
+    qint32 ancho = qFromLittleEndian<qint32>(datos + 18);
+    qint32 alto = qFromLittleEndian<qint32>(datos + 22);
+    quint16 bitsPorPixel = qFromLittleEndian<quint16>(datos + 28);
+    quint32 compresion = qFromLittleEndian<quint32>(datos + 30);
+
+    if (tamInfo < 40 || bitsPorPixel != 24 || compresion != 0) return false;
+    if (ancho <= 0 || alto == 0 || alto == INT32_MIN) return false;
+
+    vista.ancho = ancho;
+    vista.alto = alto < 0 ? -alto : alto;
+    vista.stride = strideBMP(ancho);
+    vista.filasInvertidas = alto > 0;
+    if ((qint64)inicioPixeles + vista.stride * vista.alto > tam) return false;
+
+    vista.pixeles = datos + inicioPixeles;
+    return true;
+}
+
+/**
+ * @brief Copia una vista BMP al formato interno (RGB empaquetado, fila superior primero).
+ *
+ * Es la unica copia que se hace del archivo: el intercambio BGR → RGB y la inversion
+ * de filas se hacen en la misma pasada.
+ *
+ * @param vista Vista obtenida con `AbrirBMP`.
+ * @param destino Buffer de `ancho * alto * 3` bytes.
+ */
+
+void CopiarBMPaRGB(const VistaBMP& vista, unsigned char* destino) {
+    size_t bytesFila = (size_t)vista.ancho * 3;
+
+    for (int y = 0; y < vista.alto; y++) {
+        int filaArchivo = vista.filasInvertidas ? vista.alto - 1 - y : y;
+        const unsigned char* origen = vista.pixeles + filaArchivo * vista.stride;
+        unsigned char* salida = destino + y * bytesFila;
+
+        for (size_t x = 0; x < bytesFila; x += 3) {
+            salida[x] = origen[x + 2];
+            salida[x + 1] = origen[x + 1];
+            salida[x + 2] = origen[x];
+        }
+    }
+}
+
+/**
+ * @brief Escribe un BMP de 24 bits llenando directamente el archivo mapeado en memoria.
+ *
+ * @param pixelData Pixeles en formato interno (RGB empaquetado, fila superior primero).
+ * @param width Ancho de la imagen.
+ * @param height Alto de la imagen.
+ * @param ruta Archivo de salida (se sobrescribe).
+ * @return false Si no se pudo crear o mapear el archivo.
+ */
+
+bool EscribirBMP(const unsigned char* pixelData, int width, int height, const QString& ruta) {
+    if (!pixelData || width <= 0 || height <= 0) return false;
+
+    qint64 stride = strideBMP(width);
+    qint64 tamPixeles = stride * height;
+    qint64 tamTotal = TAM_CABECERA_BMP + tamPixeles;
+    if (tamTotal > 0xFFFFFFFFLL) return false; // no cabe en la cabecera BMP
+
+    QFile archivo(ruta);
+    if (!archivo.open(QIODevice::ReadWrite | QIODevice::Truncate)) return false;
+    if (!archivo.resize(tamTotal)) return false;
+
+    uchar* datos = archivo.map(0, tamTotal);
+    if (!datos) {
+        archivo.close();
+        archivo.remove();
+        return false;
+    }
+
+    memset(datos, 0, TAM_CABECERA_BMP);
+    datos[0] = 'B';
+    datos[1] = 'M';
+    qToLittleEndian<quint32>((quint32)tamTotal, datos + 2);
+    qToLittleEndian<quint32>((quint32)TAM_CABECERA_BMP, datos + 10);
+    qToLittleEndian<quint32>(40, datos + 14);
+    qToLittleEndian<qint32>(width, datos + 18);
+    qToLittleEndian<qint32>(height, datos + 22); // positivo: filas de abajo hacia arriba
+    qToLittleEndian<quint16>(1, datos + 26);
+    qToLittleEndian<quint16>(24, datos + 28);
+    qToLittleEndian<quint32>((quint32)tamPixeles, datos + 34);
+
+    size_t bytesFila = (size_t)width * 3;
+    for (int y = 0; y < height; y++) {
+        const unsigned char* origen = pixelData + (size_t)y * bytesFila;
+        uchar* salida = datos + TAM_CABECERA_BMP + (height - 1 - y) * stride;
+
+        for (size_t x = 0; x < bytesFila; x += 3) {
+            salida[x] = origen[x + 2];
+            salida[x + 1] = origen[x + 1];
+            salida[x + 2] = origen[x];
+        }
+        memset(salida + bytesFila, 0, stride - bytesFila);
+    }
+
+    bool ok = archivo.unmap(datos);
+    archivo.close();
+    return ok;
+}
+
+/**
+ * @brief Abre un BMP de 24 bits para leerlo por bandas; solo se lee la cabecera.
+ *
+ * @param ruta Ruta del archivo BMP.
+ * @param bmp Archivo y geometria resultantes.
+ * @return false Si el archivo no existe o no es un BMP de 24 bits sin compresion.
+ */
+
+bool AbrirBMPPorBandas(const QString& ruta, ArchivoBandasBMP& bmp) {
+    bmp.archivo.setFileName(ruta);
+    if (!bmp.archivo.open(QIODevice::ReadOnly)) return false;
+
+    unsigned char cabecera[TAM_CABECERA_BMP];
+    if (bmp.archivo.read((char*)cabecera, TAM_CABECERA_BMP) != TAM_CABECERA_BMP) return false;
+    if (cabecera[0] != 'B' || cabecera[1] != 'M') return false;
+
+    quint32 inicioPixeles = qFromLittleEndian<quint32>(cabecera + 10);
+    quint32 tamInfo = qFromLittleEndian<quint32>(cabecera + 14);
+    qint32 ancho = qFromLittleEndian<qint32>(cabecera + 18);
+    qint32 alto = qFromLittleEndian<qint32>(cabecera + 22);
+    quint16 bitsPorPixel = qFromLittleEndian<quint16>(cabecera + 28);
+    quint32 compresion = qFromLittleEndian<quint32>(cabecera + 30);
+
+    if (tamInfo < 40 || bitsPorPixel != 24 || compresion != 0) return false;
+    if (ancho <= 0 || alto == 0 || alto == INT32_MIN) return false;
+
+    bmp.ancho = ancho;
+    bmp.alto = alto < 0 ? -alto : alto;
+    bmp.stride = strideBMP(ancho);
+    bmp.inicioPixeles = inicioPixeles;
+    bmp.filasInvertidas = alto > 0;
+    return bmp.inicioPixeles + bmp.stride * bmp.alto <= bmp.archivo.size();
+}
+
+/**
+ * @brief Crea un BMP de 24 bits del tamaño indicado para escribirlo por bandas.
+ *
+ * Escribe la cabecera y reserva el archivo completo; las filas se llenan despues
+ * con `EscribirBandaBMP`, en cualquier orden.
+ *
+ * @param ruta Archivo de salida (se sobrescribe).
+ * @param ancho Ancho de la imagen.
+ * @param alto Alto de la imagen.
+ * @param bmp Archivo y geometria resultantes.
+ * @return false Si no se pudo crear el archivo o no cabe en la cabecera BMP.
+ */
+
+bool CrearBMPPorBandas(const QString& ruta, int ancho, int alto, ArchivoBandasBMP& bmp) {
+    if (ancho <= 0 || alto <= 0) return false;
+
+    bmp.ancho = ancho;
+    bmp.alto = alto;
+    bmp.stride = strideBMP(ancho);
+    bmp.inicioPixeles = TAM_CABECERA_BMP;
+    bmp.filasInvertidas = true;
+
+    qint64 tamPixeles = bmp.stride * alto;
+    qint64 tamTotal = TAM_CABECERA_BMP + tamPixeles;
+    if (tamTotal > 0xFFFFFFFFLL) return false; // no cabe en la cabecera BMP
+
+    bmp.archivo.setFileName(ruta);
+    if (!bmp.archivo.open(QIODevice::ReadWrite | QIODevice::Truncate)) return false;
+    if (!bmp.archivo.resize(tamTotal)) return false;
+
+    unsigned char cabecera[TAM_CABECERA_BMP];
+    memset(cabecera, 0, TAM_CABECERA_BMP);
+    cabecera[0] = 'B';
+    cabecera[1] = 'M';
+    qToLittleEndian<quint32>((quint32)tamTotal, cabecera + 2);
+    qToLittleEndian<quint32>((quint32)TAM_CABECERA_BMP, cabecera + 10);
+    qToLittleEndian<quint32>(40, cabecera + 14);
+    qToLittleEndian<qint32>(ancho, cabecera + 18);
+    qToLittleEndian<qint32>(alto, cabecera + 22); // positivo: filas de abajo hacia arriba
+    qToLittleEndian<quint16>(1, cabecera + 26);
+    qToLittleEndian<quint16>(24, cabecera + 28);
+    qToLittleEndian<quint32>((quint32)tamPixeles, cabecera + 34);
+
+    return bmp.archivo.seek(0) && bmp.archivo.write((const char*)cabecera, TAM_CABECERA_BMP) == TAM_CABECERA_BMP;
+}
+
+// Posicion en el archivo de la primera fila almacenada de la banda [filaInicio, filaInicio + numFilas).
+// Las filas de una banda son contiguas en el archivo en ambos ordenes.
+static qint64 inicioBandaBMP(const ArchivoBandasBMP& bmp, int filaInicio, int numFilas) {
+    qint64 primeraFila = bmp.filasInvertidas ? (qint64)bmp.alto - filaInicio - numFilas : filaInicio;
+    return bmp.inicioPixeles + primeraFila * bmp.stride;
+}
+
+/**
+ * @brief Lee las filas `filaInicio` a `filaInicio + numFilas - 1` en formato interno.
+ *
+ * @param bmp Archivo abierto con `AbrirBMPPorBandas`.
+ * @param filaInicio Primera fila de la banda (0 es la fila superior).
+ * @param numFilas Numero de filas de la banda.
+ * @param destino Buffer de `ancho * numFilas * 3` bytes (RGB empaquetado, fila superior primero).
+ * @return false Si la banda se sale de la imagen o no se pudo leer.
+ */
+
+bool LeerBandaBMP(ArchivoBandasBMP& bmp, int filaInicio, int numFilas, unsigned char* destino) {
+    if (filaInicio < 0 || numFilas <= 0 || filaInicio + numFilas > bmp.alto) return false;
+
+    qint64 tamBanda = bmp.stride * numFilas;
+    bmp.crudo.resize((size_t)tamBanda);
+    if (!bmp.archivo.seek(inicioBandaBMP(bmp, filaInicio, numFilas))) return false;
+    if (bmp.archivo.read((char*)bmp.crudo.data(), tamBanda) != tamBanda) return false;
+
+    size_t bytesFila = (size_t)bmp.ancho * 3;
+    for (int y = 0; y < numFilas; y++) {
+        int filaBanda = bmp.filasInvertidas ? numFilas - 1 - y : y;
+        const unsigned char* origen = bmp.crudo.data() + filaBanda * bmp.stride;
+        unsigned char* salida = destino + (size_t)y * bytesFila;
+
+        for (size_t x = 0; x < bytesFila; x += 3) {
+            salida[x] = origen[x + 2];
+            salida[x + 1] = origen[x + 1];
+            salida[x + 2] = origen[x];
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Escribe las filas `filaInicio` a `filaInicio + numFilas - 1` de un BMP creado con `CrearBMPPorBandas`.
+ *
+ * @param bmp Archivo creado con `CrearBMPPorBandas`.
+ * @param filaInicio Primera fila de la banda (0 es la fila superior).
+ * @param numFilas Numero de filas de la banda.
+ * @param origen Pixeles de la banda en formato interno.
+ * @return false Si la banda se sale de la imagen o no se pudo escribir.
+ */
+
+bool EscribirBandaBMP(ArchivoBandasBMP& bmp, int filaInicio, int numFilas, const unsigned char* origen) {
+    if (filaInicio < 0 || numFilas <= 0 || filaInicio + numFilas > bmp.alto) return false;
+
+    qint64 tamBanda = bmp.stride * numFilas;
+    bmp.crudo.assign((size_t)tamBanda, 0);
+
+    size_t bytesFila = (size_t)bmp.ancho * 3;
+    for (int y = 0; y < numFilas; y++) {
+        const unsigned char* entrada = origen + (size_t)y * bytesFila;
+        unsigned char* salida = bmp.crudo.data() + (numFilas - 1 - y) * bmp.stride;
+
+        for (size_t x = 0; x < bytesFila; x += 3) {
+            salida[x] = entrada[x + 2];
+            salida[x + 1] = entrada[x + 1];
+            salida[x + 2] = entrada[x];
+        }
+    }
+
+    if (!bmp.archivo.seek(inicioBandaBMP(bmp, filaInicio, numFilas))) return false;
+    return bmp.archivo.write((const char*)bmp.crudo.data(), tamBanda) == tamBanda;
+}
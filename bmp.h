@@ -0,0 +1,43 @@
+#ifndef BMP_H
+#define BMP_H
+
+#include <QFile>
+#include <QString>
+#include <vector>
+
+/**
+ * Vista sobre los pixeles de un BMP de 24 bits sin compresion mapeado en memoria.
+ * Los pixeles estan en orden BGR tal como los guarda el archivo.
+ */
+struct VistaBMP {
+    const unsigned char* pixeles; // primera fila almacenada en el archivo
+    int ancho;
+    int alto;
+    qint64 stride;                // bytes por fila almacenada (multiplo de 4)
+    bool filasInvertidas;         // true: la primera fila almacenada es la inferior
+};
+
+/**
+ * BMP de 24 bits que se lee o escribe por bandas de filas sin tenerlo entero en memoria.
+ * Solo se guarda la cabecera; cada banda se lee o escribe con una llamada al archivo.
+ */
+struct ArchivoBandasBMP {
+    QFile archivo;
+    int ancho = 0;
+    int alto = 0;
+    qint64 stride = 0;             // bytes por fila almacenada (multiplo de 4)
+    qint64 inicioPixeles = 0;
+    bool filasInvertidas = true;   // true: la primera fila almacenada es la inferior
+    std::vector<unsigned char> crudo; // filas de la banda tal como estan en el archivo
+};
+
+bool AbrirBMP(const QString& ruta, QFile& archivo, VistaBMP& vista);
+void CopiarBMPaRGB(const VistaBMP& vista, unsigned char* destino);
+bool EscribirBMP(const unsigned char* pixelData, int width, int height, const QString& ruta);
+
+bool AbrirBMPPorBandas(const QString& ruta, ArchivoBandasBMP& bmp);
+bool CrearBMPPorBandas(const QString& ruta, int ancho, int alto, ArchivoBandasBMP& bmp);
+bool LeerBandaBMP(ArchivoBandasBMP& bmp, int filaInicio, int numFilas, unsigned char* destino);
+bool EscribirBandaBMP(ArchivoBandasBMP& bmp, int filaInicio, int numFilas, const unsigned char* origen);
+
+#endif // BMP_H
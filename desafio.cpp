@@ -0,0 +1,398 @@
+#include "desafio.h"
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "imagen.h"
+#include "memoria.h"
+#include "operaciones_paralelas.h"
+#include "planificacion.h"
+#include "registro.h"
+#include "traza.h"
+#include "validacion.h"
+
+using namespace std;
+
+/*
+ * Implementacion de la API de desafio.h sobre el planificador, los validadores y los
+ * kernels paralelos. Nada de aqui abre archivos: la aplicacion (main.cpp) carga los
+ * casos, llama a estas funciones y exporta los resultados.
+ */
+
+// Mensajes de una llamada: mientras exista, lo que el hilo escribe con salida(),
+// salidaError() o el registro va linea por linea a `opciones->mensaje` (o se descarta)
+class AmbitoMensajes {
+public:
+    explicit AmbitoMensajes(const DesafioOpciones* opciones)
+        : salidaLlamada([opciones](const string& linea) {
+              if (opciones && opciones->mensaje) opciones->mensaje(linea.c_str(), opciones->contexto);
+          }),
+          ambito(&salidaLlamada) {}
+    ~AmbitoMensajes() { salidaLlamada.vaciar(); }
+
+    AmbitoMensajes(const AmbitoMensajes&) = delete;
+    AmbitoMensajes& operator=(const AmbitoMensajes&) = delete;
+
+private:
+    SalidaPorLineas salidaLlamada;
+    AmbitoSalida ambito;
+};
+
+static bool imagenValida(const DesafioImagen& imagen) {
+    return imagen.pixeles && imagen.ancho > 0 && imagen.alto > 0;
+}
+
+static bool operacionValida(int operacion) {
+    for (int i = 0; i < NUM_CANDIDATOS; i++) {
+        if (CodigoCandidato(i) == operacion) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Comprueba que cada etapa traiga al menos las sumas que lee su ventana.
+ *
+ * `longitudes[i]` es el largo de la ventana de la etapa i; los validadores leen una suma
+ * por byte de la ventana, asi un M*.txt incompleto se rechaza aqui en lugar de leerse
+ * fuera de su arreglo.
+ */
+static bool etapasValidas(const DesafioEtapa* etapas, const long long* longitudes, int numEtapas) {
+    if (numEtapas < 0 || (numEtapas > 0 && !etapas)) return false;
+    for (int i = 0; i < numEtapas; i++) {
+        if (!etapas[i].sumas || etapas[i].numPixeles < 0) return false;
+        if ((long long)etapas[i].numPixeles * 3 < longitudes[i]) return false;
+    }
+    return true;
+}
+
+// Largo de la ventana de la semilla: la mascara recortada al final de la imagen
+static long long longitudVentana(long long semilla, long long totalBytes, const DesafioImagen& mascara) {
+    long long maskSize = (long long)mascara.ancho * mascara.alto * 3;
+    if (semilla < 0 || semilla >= totalBytes) return 0;
+    return totalBytes - semilla < maskSize ? totalBytes - semilla : maskSize;
+}
+
+static int validarEntrada(const DesafioEntrada* entrada) {
+    if (!entrada || !imagenValida(entrada->distorsionada) || !imagenValida(entrada->imagenXOR) || !imagenValida(entrada->mascara)) {
+        return DESAFIO_ERROR_ARGUMENTOS;
+    }
+    if (entrada->distorsionada.ancho != entrada->imagenXOR.ancho || entrada->distorsionada.alto != entrada->imagenXOR.alto) {
+        return DESAFIO_ERROR_ARGUMENTOS;
+    }
+    if (entrada->numEtapas < 0 || (entrada->numEtapas > 0 && !entrada->etapas)) return DESAFIO_ERROR_ARGUMENTOS;
+
+    long long totalBytes = (long long)entrada->distorsionada.ancho * entrada->distorsionada.alto * 3;
+    vector<long long> longitudes(entrada->numEtapas);
+    for (int i = 0; i < entrada->numEtapas; i++) {
+        longitudes[i] = longitudVentana(entrada->etapas[i].semilla, totalBytes, entrada->mascara);
+    }
+    return etapasValidas(entrada->etapas, longitudes.data(), entrada->numEtapas) ? DESAFIO_OK : DESAFIO_ERROR_ARGUMENTOS;
+}
+
+// Las etapas en la forma que espera el planificador (un arreglo por campo)
+struct EtapasPlanificador {
+    vector<const unsigned int*> sumas;
+    vector<long long> semillas;
+
+    EtapasPlanificador(const DesafioEtapa* etapas, int numEtapas) : sumas(numEtapas), semillas(numEtapas) {
+        for (int i = 0; i < numEtapas; i++) {
+            sumas[i] = etapas[i].sumas;
+            semillas[i] = etapas[i].semilla;
+        }
+    }
+};
+
+static int planificar(const DesafioEntrada& entrada, int* operaciones) {
+    EtapasPlanificador etapas(entrada.etapas, entrada.numEtapas);
+    bool planificada = PlanificarReconstruccion(entrada.distorsionada.pixeles, entrada.imagenXOR.pixeles, entrada.mascara.pixeles,
+                                                etapas.sumas.data(), etapas.semillas.data(), entrada.numEtapas,
+                                                entrada.distorsionada.ancho, entrada.distorsionada.alto,
+                                                entrada.mascara.ancho, entrada.mascara.alto, operaciones);
+    return planificada ? DESAFIO_OK : DESAFIO_ERROR_PLANIFICACION;
+}
+
+/**
+ * @brief Verifica sobre la imagen completa la operacion planificada para una etapa.
+ *
+ * La operacion se elige antes con `PlanificarReconstruccion`, que busca en profundidad
+ * una combinacion de operaciones valida para todas las etapas. Aqui solo se confirma
+ * que esa operacion reproduce los datos de enmascaramiento de la etapa.
+ *
+ * @param actualIMG Puntero a la imagen distorsionada actual.
+ * @param IM Puntero a la imagen para aplicar XOR.
+ * @param M Puntero a la imagen de mascara.
+ * @param datosMascara Puntero a datos auxiliares de la mascara.
+ * @param semilla Desplazamiento de la ventana de la mascara en la imagen.
+ * @param anchoIMG Ancho de la imagen en pixeles.
+ * @param altoIMG Alto de la imagen en pixeles.
+ * @param mask_ancho Ancho de la mascara en pixeles.
+ * @param mask_alto Alto de la mascara en pixeles.
+ * @param operacion Codigo de la operacion planificada (1, 2X o 3X).
+ *
+ * @return true Si la operacion reproduce los datos de la etapa.
+ *
+ * @see PlanificarReconstruccion, ValidarVentanaOperacion
+ */
+
+static bool VerificarOperacionEtapa(const unsigned char* actualIMG, const unsigned char* IM, const unsigned char* M, const unsigned int* datosMascara, long long semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int operacion) {
+    AmbitoTraza traza("deteccion", "VerificarOperacionEtapa");
+
+    if (!ValidarVentanaOperacion(actualIMG, IM, M, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto, operacion)) {
+        salidaError() << "Error: La operacion planificada no reproduce los datos de la etapa\n";
+        return false;
+    }
+
+    if (operacion == 1) {
+        salida() << "Operacion XOR validada correctamente\n";
+    } else if (operacion / 10 == 2) {
+        salida() << "Rotacion izquierda de " << operacion % 10 << " bits validada\n";
+    } else {
+        salida() << "Rotacion derecha de " << operacion % 10 << " bits validada\n";
+    }
+    return true;
+}
+
+/**
+ * @brief Aplica la operacion inversa a una imagen distorsionada, dependiendo del tipo de transformacion detectada.
+ *
+ * Esta funcion realiza la operacion inversa sobre una imagen `actualIMG`, utilizando
+ * informacion de la imagen `IM` y el codigo de operacion proporcionado. Soporta:
+ * - XOR inverso (usando la misma imagen XOR).
+ * - Rotacion izquierda (para revertir rotaciones derechas).
+ * - Rotacion derecha (para revertir rotaciones izquierdas).
+ *
+ * @param actualIMG Puntero a la imagen distorsionada.
+ * @param IM Puntero a la imagen auxiliar utilizada para revertir la operacion (solo para XOR).
+ * @param destino Buffer donde se escribe el resultado (puede ser `actualIMG`).
+ * @param operation Codigo de operacion inversa detectado (por ejemplo, 1 para XOR, 22 para rotacion izq. de 2 bits).
+ * @param anchoIMG Ancho de la imagen en pixeles.
+ * @param altoIMG Alto de la imagen en pixeles.
+ *
+ * @return true Si la operacion se aplico sobre `destino`.
+ * @return false Si la operacion es desconocida o faltan datos.
+ *
+ * Las operaciones se reparten en bandas entre los hilos del pool (ver operaciones_paralelas.h).
+ *
+ * @see DoXORParalelo, RotarIzquierdaParalelo, RotarDerechaParalelo
+ */
+
+static bool aplicarOperacionInversa(const unsigned char* actualIMG, const unsigned char* IM, unsigned char* destino, int operation, int anchoIMG, int altoIMG) {
+    bool result = false;
+
+    switch (operation / 10) {
+    case 0: // XOR
+        REGISTRO_DEPURACION << "Aplicando XOR inverso\n";
+        result = DoXORParalelo(actualIMG, IM, destino, anchoIMG, altoIMG);
+        break;
+
+    case 2: // Rotacion derecha original → izquierda inversa
+        REGISTRO_DEPURACION << "Aplicando rotacion izquierda de " << operation%10 << " bits\n";
+        result = RotarIzquierdaParalelo(actualIMG, destino, (size_t)anchoIMG * altoIMG, operation%10);
+        break;
+
+    case 3: // Rotacion izquierda original → derecha inversa
+        REGISTRO_DEPURACION << "Aplicando rotacion derecha de " << operation%10 << " bits\n";
+        result = RotarDerechaParalelo(actualIMG, destino, (size_t)anchoIMG * altoIMG, operation%10);
+        break;
+
+    default:
+        salidaError() << "Operacion desconocida: " << operation << '\n';
+        break;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Deshace las etapas una por una, verificando cada operacion sobre la imagen completa.
+ *
+ * Usa dos buffers que se alternan entre etapas: `destino` y uno temporal. El primero se
+ * elige segun la paridad del numero de etapas para que la ultima escriba en `destino`.
+ */
+static int reconstruirPorEtapas(const DesafioEntrada& entrada, const DesafioOpciones* opciones, const int* operaciones, unsigned char* destino) {
+    int numEtapas = entrada.numEtapas;
+    int width = entrada.distorsionada.ancho, height = entrada.distorsionada.alto;
+    size_t bytesImagen = (size_t)width * height * 3;
+
+    if (numEtapas == 0) {
+        memcpy(destino, entrada.distorsionada.pixeles, bytesImagen);
+        return DESAFIO_OK;
+    }
+
+    AmbitoMemoria faseAplicacion(FASE_APLICACION);
+    Imagen temporal = numEtapas > 1 ? Imagen(width, height) : Imagen();
+    unsigned char* buffers[2] = { destino, temporal.datos() };
+    int siguiente = numEtapas % 2 == 1 ? 0 : 1;
+    const unsigned char* actual = entrada.distorsionada.pixeles;
+
+    for (int etapa = numEtapas - 1; etapa >= 0; etapa--) {
+        AmbitoTraza traza("etapa", "EtapaInversa", (long long)bytesImagen);
+        traza.argumento("etapa", etapa + 1);
+
+        int operacion = operaciones[etapa];
+        const DesafioEtapa& datos = entrada.etapas[etapa];
+        bool verificada;
+        {
+            AmbitoMemoria fase(FASE_DETECCION, etapa);
+            verificada = VerificarOperacionEtapa(actual, entrada.imagenXOR.pixeles, entrada.mascara.pixeles, datos.sumas, datos.semilla,
+                                                 width, height, entrada.mascara.ancho, entrada.mascara.alto, operacion);
+        }
+        if (!verificada) {
+            salidaError() << "No se pudo verificar la operacion de la etapa " << etapa << '\n';
+            return DESAFIO_ERROR_VERIFICACION;
+        }
+
+        unsigned char* salidaEtapa = buffers[siguiente];
+        siguiente ^= 1;
+        bool aplicada;
+        {
+            AmbitoMemoria fase(FASE_APLICACION, etapa);
+            aplicada = aplicarOperacionInversa(actual, operacion == 1 ? entrada.imagenXOR.pixeles : nullptr, salidaEtapa, operacion, width, height);
+        }
+        if (!aplicada) {
+            salidaError() << "Error al aplicar operacion inversa en etapa " << etapa << '\n';
+            return DESAFIO_ERROR_VERIFICACION;
+        }
+        actual = salidaEtapa;
+
+        if (opciones && opciones->etapaAplicada) {
+            opciones->etapaAplicada(etapa, operacion, actual, opciones->contexto);
+        }
+    }
+    return DESAFIO_OK;
+}
+
+/**
+ * @brief Detecta la operacion de cada etapa y reconstruye la imagen original.
+ *
+ * Sin `porEtapas` aplica la cadena inversa fusionada en una sola pasada por bloques
+ * (ver `AplicarCadenaInversaParalela`); con `porEtapas` deshace una etapa por vez y
+ * entrega cada imagen intermedia a `etapaAplicada`.
+ */
+int desafio_reconstruir(const DesafioEntrada* entrada, const DesafioOpciones* opciones, int* operaciones, unsigned char* destino) {
+    try {
+        int estado = validarEntrada(entrada);
+        if (estado != DESAFIO_OK) return estado;
+        if (!destino || (entrada->numEtapas > 0 && !operaciones)) return DESAFIO_ERROR_ARGUMENTOS;
+
+        AmbitoMensajes mensajes(opciones);
+        AmbitoTraza traza("etapa", "desafio_reconstruir", (long long)entrada->distorsionada.ancho * entrada->distorsionada.alto * 3);
+        traza.argumento("etapas", entrada->numEtapas);
+
+        estado = planificar(*entrada, operaciones);
+        if (estado != DESAFIO_OK) return estado;
+        if (opciones && opciones->porEtapas) return reconstruirPorEtapas(*entrada, opciones, operaciones, destino);
+
+        AmbitoMemoria fase(FASE_APLICACION);
+        int numEtapas = entrada->numEtapas;
+        vector<PasoInverso> pasos(numEtapas > 0 ? numEtapas : 1);
+        int numPasos = CompilarCadenaInversa(operaciones, numEtapas - 1, 0, pasos.data());
+
+        salida() << "\nAplicando cadena inversa fusionada (" << numPasos << " pasos)\n";
+        AplicarCadenaInversaParalela(entrada->distorsionada.pixeles, entrada->imagenXOR.pixeles, destino,
+                                     (size_t)entrada->distorsionada.ancho * entrada->distorsionada.alto * 3, pasos.data(), numPasos);
+        return DESAFIO_OK;
+    } catch (const bad_alloc&) {
+        return DESAFIO_ERROR_MEMORIA;
+    } catch (...) {
+        return DESAFIO_ERROR_INTERNO;
+    }
+}
+
+int desafio_planificar(const DesafioEntrada* entrada, const DesafioOpciones* opciones, int* operaciones) {
+    try {
+        int estado = validarEntrada(entrada);
+        if (estado != DESAFIO_OK) return estado;
+        if (entrada->numEtapas > 0 && !operaciones) return DESAFIO_ERROR_ARGUMENTOS;
+
+        AmbitoMensajes mensajes(opciones);
+        return planificar(*entrada, operaciones);
+    } catch (const bad_alloc&) {
+        return DESAFIO_ERROR_MEMORIA;
+    } catch (...) {
+        return DESAFIO_ERROR_INTERNO;
+    }
+}
+
+int desafio_planificar_ventanas(const unsigned char* const* ventanasID, const unsigned char* const* ventanasIM,
+                                const int* longitudes, DesafioImagen mascara, const DesafioEtapa* etapas,
+                                int numEtapas, const DesafioOpciones* opciones, int* operaciones) {
+    if (!imagenValida(mascara) || numEtapas < 0) return DESAFIO_ERROR_ARGUMENTOS;
+    if (numEtapas > 0 && (!ventanasID || !ventanasIM || !longitudes || !operaciones)) return DESAFIO_ERROR_ARGUMENTOS;
+
+    try {
+        long long maskSize = (long long)mascara.ancho * mascara.alto * 3;
+        vector<long long> longitudesVentana(numEtapas);
+        for (int i = 0; i < numEtapas; i++) {
+            if (longitudes[i] < 0 || longitudes[i] > maskSize) return DESAFIO_ERROR_ARGUMENTOS;
+            if (longitudes[i] > 0 && (!ventanasID[i] || !ventanasIM[i])) return DESAFIO_ERROR_ARGUMENTOS;
+            longitudesVentana[i] = longitudes[i];
+        }
+        if (!etapasValidas(etapas, longitudesVentana.data(), numEtapas)) return DESAFIO_ERROR_ARGUMENTOS;
+
+        AmbitoMensajes mensajes(opciones);
+        EtapasPlanificador datos(etapas, numEtapas);
+        bool planificada = PlanificarReconstruccionVentanas(ventanasID, ventanasIM, longitudes, mascara.pixeles,
+                                                            datos.sumas.data(), numEtapas, operaciones);
+        return planificada ? DESAFIO_OK : DESAFIO_ERROR_PLANIFICACION;
+    } catch (const bad_alloc&) {
+        return DESAFIO_ERROR_MEMORIA;
+    } catch (...) {
+        return DESAFIO_ERROR_INTERNO;
+    }
+}
+
+int desafio_aplicar_operaciones(const int* operaciones, int numEtapas, const unsigned char* origen,
+                                const unsigned char* imagenXOR, unsigned char* destino, size_t bytes) {
+    if (numEtapas < 0 || (numEtapas > 0 && !operaciones) || !origen || !destino) return DESAFIO_ERROR_ARGUMENTOS;
+    for (int i = 0; i < numEtapas; i++) {
+        if (!operacionValida(operaciones[i]) || (operaciones[i] == 1 && !imagenXOR)) return DESAFIO_ERROR_ARGUMENTOS;
+    }
+
+    try {
+        AmbitoMensajes mensajes(nullptr);
+        AmbitoMemoria fase(FASE_APLICACION);
+        vector<PasoInverso> pasos(numEtapas > 0 ? numEtapas : 1);
+        int numPasos = CompilarCadenaInversa(operaciones, numEtapas - 1, 0, pasos.data());
+        AplicarCadenaInversaParalela(origen, imagenXOR, destino, bytes, pasos.data(), numPasos);
+        return DESAFIO_OK;
+    } catch (const bad_alloc&) {
+        return DESAFIO_ERROR_MEMORIA;
+    } catch (...) {
+        return DESAFIO_ERROR_INTERNO;
+    }
+}
+
+int desafio_validar_etapa(DesafioImagen imagen, DesafioImagen mascara, const DesafioEtapa* etapa) {
+    if (!imagenValida(imagen) || !imagenValida(mascara) || !etapa) return 0;
+    long long longitud = longitudVentana(etapa->semilla, (long long)imagen.ancho * imagen.alto * 3, mascara);
+    if (!etapasValidas(etapa, &longitud, 1)) return 0;
+
+    try {
+        AmbitoMensajes mensajes(nullptr);
+        return ValidarSumaMascara(imagen.pixeles, mascara.pixeles, etapa->sumas, etapa->semilla,
+                                  imagen.ancho, imagen.alto, mascara.ancho, mascara.alto) ? 1 : 0;
+    } catch (...) {
+        return 0;
+    }
+}
+
+const char* desafio_descripcion_error(int codigo) {
+    switch (codigo) {
+    case DESAFIO_OK:
+        return "sin error";
+    case DESAFIO_ERROR_ARGUMENTOS:
+        return "argumentos no validos (punteros nulos, dimensiones o etapas incoherentes)";
+    case DESAFIO_ERROR_PLANIFICACION:
+        return "ninguna combinacion de operaciones cumple todas las etapas";
+    case DESAFIO_ERROR_VERIFICACION:
+        return "una operacion no reproduce su etapa sobre la imagen completa";
+    case DESAFIO_ERROR_MEMORIA:
+        return "memoria insuficiente";
+    case DESAFIO_ERROR_INTERNO:
+        return "error interno de la biblioteca";
+    default:
+        return "codigo de error desconocido";
+    }
+}
@@ -0,0 +1,119 @@
+#ifndef DESAFIO_H
+#define DESAFIO_H
+
+/*
+ * API de la biblioteca de reconstruccion (libdesafio).
+ *
+ * Trabaja solo sobre buffers del llamador: no lee ni escribe archivos. Las imagenes son
+ * RGB de 8 bits por canal, contiguas (ancho * 3 bytes por fila, sin relleno) y con la
+ * fila superior primero, igual que las carga la aplicacion. Los datos de cada etapa son
+ * los de su archivo M*.txt: la semilla y las sumas esperadas (3 por pixel de M).
+ *
+ * Las funciones se pueden llamar desde varios hilos a la vez; internamente reparten el
+ * trabajo en el pool de hilos de la biblioteca. Las que reciben `DesafioOpciones`
+ * aceptan NULL (sin mensajes ni devoluciones de llamada).
+ */
+
+#include <stddef.h>
+
+#if defined(DESAFIO_BIBLIOTECA_COMPARTIDA)
+#  if defined(_WIN32)
+#    if defined(DESAFIO_CONSTRUYENDO)
+#      define DESAFIO_API __declspec(dllexport)
+#    else
+#      define DESAFIO_API __declspec(dllimport)
+#    endif
+#  else
+#    define DESAFIO_API __attribute__((visibility("default")))
+#  endif
+#else
+#  define DESAFIO_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DESAFIO_VERSION_API 2
+
+/* Codigos de resultado */
+#define DESAFIO_OK 0
+#define DESAFIO_ERROR_ARGUMENTOS -1    /* punteros nulos, dimensiones o etapas incoherentes */
+#define DESAFIO_ERROR_PLANIFICACION -2 /* ninguna combinacion de operaciones cumple todas las etapas */
+#define DESAFIO_ERROR_VERIFICACION -3  /* una operacion no reproduce su etapa sobre la imagen completa */
+#define DESAFIO_ERROR_MEMORIA -4
+#define DESAFIO_ERROR_INTERNO -5       /* excepcion inesperada dentro de la biblioteca */
+
+/* Imagen RGB contigua del llamador */
+typedef struct DesafioImagen {
+    const unsigned char* pixeles;
+    int ancho;
+    int alto;
+} DesafioImagen;
+
+/* Datos de enmascaramiento de una etapa (un archivo M*.txt) */
+typedef struct DesafioEtapa {
+    const unsigned int* sumas;  /* numPixeles * 3 valores */
+    int numPixeles;
+    long long semilla;          /* desplazamiento en bytes de la ventana de M en la imagen */
+} DesafioEtapa;
+
+typedef struct DesafioEntrada {
+    DesafioImagen distorsionada;  /* I_D */
+    DesafioImagen imagenXOR;      /* I_M, de las mismas dimensiones que I_D */
+    DesafioImagen mascara;        /* M */
+    const DesafioEtapa* etapas;   /* etapas[i]: datos de M(i+1).txt */
+    int numEtapas;
+} DesafioEntrada;
+
+/* Se llama tras aplicar cada etapa (modo por etapas); `pixeles` vale hasta la siguiente llamada */
+typedef void (*DesafioEtapaAplicada)(int etapa, int operacion, const unsigned char* pixeles, void* contexto);
+/* Recibe cada linea de mensajes (sin '\n') a medida que se escribe */
+typedef void (*DesafioMensaje)(const char* linea, void* contexto);
+
+typedef struct DesafioOpciones {
+    int porEtapas;                       /* 0: cadena fusionada en una pasada; 1: etapa por etapa */
+    DesafioEtapaAplicada etapaAplicada;  /* solo con porEtapas; puede ser NULL */
+    DesafioMensaje mensaje;              /* NULL: los mensajes se descartan */
+    void* contexto;
+} DesafioOpciones;
+
+/*
+ * Detecta la operacion de cada etapa y reconstruye la imagen anterior a todas ellas.
+ *
+ * `operaciones` recibe numEtapas codigos (1: XOR con I_M, 2X / 3X: rotacion de X bits)
+ * y `destino` ancho * alto * 3 bytes; no debe solaparse con las entradas. En modo por
+ * etapas cada operacion se verifica tambien sobre la imagen completa antes de aplicarla.
+ */
+DESAFIO_API int desafio_reconstruir(const DesafioEntrada* entrada, const DesafioOpciones* opciones,
+                                    int* operaciones, unsigned char* destino);
+
+/* Solo la deteccion: las operaciones de todas las etapas, sin reconstruir la imagen */
+DESAFIO_API int desafio_planificar(const DesafioEntrada* entrada, const DesafioOpciones* opciones, int* operaciones);
+
+/*
+ * Deteccion a partir de las ventanas de cada etapa (bytes de I_D e I_M desde la semilla,
+ * `longitudes[i]` bytes), para quien no tiene las imagenes completas en memoria.
+ */
+DESAFIO_API int desafio_planificar_ventanas(const unsigned char* const* ventanasID, const unsigned char* const* ventanasIM,
+                                            const int* longitudes, DesafioImagen mascara, const DesafioEtapa* etapas,
+                                            int numEtapas, const DesafioOpciones* opciones, int* operaciones);
+
+/*
+ * Deshace las operaciones detectadas sobre un tramo cualquiera de la imagen (por ejemplo,
+ * una banda de filas). `imagenXOR` es el mismo tramo de I_M (puede ser NULL si ninguna
+ * operacion es XOR). `origen` y `destino` pueden ser el mismo buffer.
+ */
+DESAFIO_API int desafio_aplicar_operaciones(const int* operaciones, int numEtapas, const unsigned char* origen,
+                                            const unsigned char* imagenXOR, unsigned char* destino, size_t bytes);
+
+/* 1 si `imagen` mas M reproduce las sumas de `etapa` (por ejemplo, M0.txt), 0 si no */
+DESAFIO_API int desafio_validar_etapa(DesafioImagen imagen, DesafioImagen mascara, const DesafioEtapa* etapa);
+
+DESAFIO_API const char* desafio_descripcion_error(int codigo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DESAFIO_H */
@@ -0,0 +1,100 @@
+#include "exportacion.h"
+#include <cstring>
+#include <iostream>
+
+#include "memoria.h"
+#include "procesamiento.h"
+#include "registro.h"
+
+using namespace std;
+
+ExportadorAsincrono::ExportadorAsincrono(int capacidad)
+    : capacidad(capacidad < 1 ? 1 : capacidad), salidaCreador(SalidaActual()) {
+    hilo = std::thread(&ExportadorAsincrono::bucleEscritura, this);
+}
+
+ExportadorAsincrono::~ExportadorAsincrono() {
+    finalizar();
+}
+
+/**
+ * @brief Encola una copia de la imagen para escribirla en segundo plano.
+ *
+ * Si ya hay `capacidad` imagenes esperando, se bloquea hasta que el hilo de
+ * escritura libere un lugar.
+ */
+void ExportadorAsincrono::encolar(const unsigned char* pixelData, int width, int height, const QString& archivoSalida) {
+    AmbitoMemoria fase(FASE_EXPORTACION);
+    size_t bytes = (size_t)width * height * 3;
+    std::unique_ptr<unsigned char[]> copia(new unsigned char[bytes]);
+    memcpy(copia.get(), pixelData, bytes);
+
+    unique_lock<mutex> lock(cerrojo);
+    hayEspacio.wait(lock, [&] { return (int)cola.size() < capacidad || terminar; });
+    if (terminar) {
+        fallidos.push_back(archivoSalida);
+        return;
+    }
+    cola.push_back(Trabajo{std::move(copia), width, height, archivoSalida});
+    hayTrabajo.notify_one();
+}
+
+/**
+ * @brief Espera a que se escriban todas las imagenes pendientes y detiene el hilo.
+ *
+ * @return int Numero de exportaciones que fallaron durante toda la ejecucion.
+ */
+int ExportadorAsincrono::finalizar() {
+    {
+        lock_guard<mutex> lock(cerrojo);
+        terminar = true;
+    }
+    hayTrabajo.notify_all();
+    hayEspacio.notify_all();
+    if (hilo.joinable()) {
+        hilo.join();
+        salida() << "Exportaciones escritas: " << escritos << ", fallidas: " << fallidos.size() << '\n';
+        for (const QString& ruta : fallidos) {
+            salidaError() << "  No se pudo guardar " << ruta.toStdString() << '\n';
+        }
+    }
+    return (int)fallidos.size();
+}
+
+/**
+ * @brief Indica si la exportacion de `archivoSalida` fallo (valido tras `finalizar`).
+ */
+bool ExportadorAsincrono::fallo(const QString& archivoSalida) const {
+    lock_guard<mutex> lock(cerrojo);
+    for (const QString& ruta : fallidos) {
+        if (ruta == archivoSalida) return true;
+    }
+    return false;
+}
+
+void ExportadorAsincrono::bucleEscritura() {
+    // Los mensajes del hilo de escritura van al mismo destino que los de quien creo la cola
+    AmbitoSalida ambito(salidaCreador);
+    AmbitoMemoria fase(FASE_EXPORTACION);
+
+    while (true) {
+        Trabajo trabajo;
+        {
+            unique_lock<mutex> lock(cerrojo);
+            hayTrabajo.wait(lock, [&] { return terminar || !cola.empty(); });
+            if (cola.empty()) return;
+            trabajo = std::move(cola.front());
+            cola.pop_front();
+        }
+        hayEspacio.notify_one();
+
+        bool ok = exportImage(trabajo.pixeles.get(), trabajo.width, trabajo.height, trabajo.archivoSalida);
+
+        lock_guard<mutex> lock(cerrojo);
+        if (ok) {
+            escritos++;
+        } else {
+            fallidos.push_back(trabajo.archivoSalida);
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef EXPORTACION_H
+#define EXPORTACION_H
+
+#include <QString>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class SalidaCaso;
+
+/**
+ * Cola acotada de exportaciones BMP que se escriben en un hilo de fondo.
+ *
+ * `encolar` copia los pixeles (el llamador puede reutilizar su buffer de inmediato) y
+ * se bloquea mientras la cola este llena, de modo que nunca hay mas de `capacidad`
+ * copias en memoria. `finalizar` espera a que se escriba todo e informa los errores.
+ */
+class ExportadorAsincrono {
+public:
+    explicit ExportadorAsincrono(int capacidad = 2);
+    ~ExportadorAsincrono();
+
+    ExportadorAsincrono(const ExportadorAsincrono&) = delete;
+    ExportadorAsincrono& operator=(const ExportadorAsincrono&) = delete;
+
+    void encolar(const unsigned char* pixelData, int width, int height, const QString& archivoSalida);
+    int finalizar();
+    bool fallo(const QString& archivoSalida) const;
+
+private:
+    struct Trabajo {
+        std::unique_ptr<unsigned char[]> pixeles;
+        int width;
+        int height;
+        QString archivoSalida;
+    };
+
+    void bucleEscritura();
+
+    int capacidad;
+    SalidaCaso* salidaCreador;
+    std::deque<Trabajo> cola;
+    std::vector<QString> fallidos;
+    int escritos = 0;
+    bool terminar = false;
+    mutable std::mutex cerrojo;
+    std::condition_variable hayTrabajo;
+    std::condition_variable hayEspacio;
+    std::thread hilo;
+};
+
+#endif // EXPORTACION_H
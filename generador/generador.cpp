@@ -0,0 +1,385 @@
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStringList>
+
+#include "hilos.h"
+#include "operaciones.h"
+#include "planificacion.h"
+#include "procesamiento.h"
+#include "registro.h"
+
+using namespace std;
+
+// Configuracion de los casos a generar
+struct OpcionesGenerador {
+    QString entrada;             // directorio con I_O.bmp, I_M.bmp y M.bmp (vacio: datos sinteticos)
+    QString salidaCasos;         // directorio donde se escriben los casos
+    int numCasos = 1;            // mas de uno: un subdirectorio por caso
+    int ancho = 640;             // tamaño de las imagenes sinteticas
+    int alto = 480;
+    int mascaraAncho = 8;        // tamaño de la mascara sintetica
+    int mascaraAlto = 8;
+    int numEtapas = 6;           // etapas aleatorias si no se indican operaciones
+    vector<int> operaciones;     // codigos por etapa (1, 2X o 3X)
+    vector<long long> semillas;  // desplazamiento en bytes por etapa
+    unsigned long long semillaAleatoria = 1;
+};
+
+// Imagenes de entrada de un caso
+struct ImagenesCaso {
+    unsigned char* IO = nullptr;
+    unsigned char* IM = nullptr;
+    unsigned char* M = nullptr;
+    int width = 0, height = 0, mask_width = 0, mask_height = 0;
+};
+
+// Generador xorshift64*: rapido y reproducible a partir de la semilla
+static unsigned long long siguienteAleatorio(unsigned long long& estado) {
+    estado ^= estado >> 12;
+    estado ^= estado << 25;
+    estado ^= estado >> 27;
+    return estado * 2685821657736338717ULL;
+}
+
+static void llenarAleatorio(unsigned char* destino, size_t bytes, unsigned long long& estado) {
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        unsigned long long valor = siguienteAleatorio(estado);
+        memcpy(destino + i, &valor, 8);
+    }
+    if (i < bytes) {
+        unsigned long long valor = siguienteAleatorio(estado);
+        memcpy(destino + i, &valor, bytes - i);
+    }
+}
+
+static void liberarImagenes(ImagenesCaso& imagenes) {
+    delete[] imagenes.IO;
+    delete[] imagenes.IM;
+    delete[] imagenes.M;
+    imagenes.IO = imagenes.IM = imagenes.M = nullptr;
+}
+
+/**
+ * @brief Carga I_O.bmp, I_M.bmp y M.bmp de un directorio.
+ */
+static bool cargarImagenes(const QString& directorio, ImagenesCaso& imagenes) {
+    int anchoIM = 0, altoIM = 0;
+    imagenes.IO = loadPixels(directorio + "I_O.bmp", imagenes.width, imagenes.height);
+    imagenes.IM = loadPixels(directorio + "I_M.bmp", anchoIM, altoIM);
+    imagenes.M = loadPixels(directorio + "M.bmp", imagenes.mask_width, imagenes.mask_height);
+
+    if (!imagenes.IO || !imagenes.IM || !imagenes.M) {
+        salidaError() << "Error: no se pudieron cargar I_O.bmp, I_M.bmp y M.bmp de " << directorio.toStdString() << endl;
+        liberarImagenes(imagenes);
+        return false;
+    }
+    if (anchoIM != imagenes.width || altoIM != imagenes.height) {
+        salidaError() << "Error: I_O.bmp e I_M.bmp no tienen las mismas dimensiones" << endl;
+        liberarImagenes(imagenes);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Crea imagenes I_O, I_M y M con contenido pseudoaleatorio.
+ */
+static void generarImagenes(const OpcionesGenerador& opciones, unsigned long long& estado, ImagenesCaso& imagenes) {
+    imagenes.width = opciones.ancho;
+    imagenes.height = opciones.alto;
+    imagenes.mask_width = opciones.mascaraAncho;
+    imagenes.mask_height = opciones.mascaraAlto;
+
+    size_t bytesImagen = (size_t)imagenes.width * imagenes.height * 3;
+    size_t bytesMascara = (size_t)imagenes.mask_width * imagenes.mask_height * 3;
+    imagenes.IO = new unsigned char[bytesImagen];
+    imagenes.IM = new unsigned char[bytesImagen];
+    imagenes.M = new unsigned char[bytesMascara];
+    llenarAleatorio(imagenes.IO, bytesImagen, estado);
+    llenarAleatorio(imagenes.IM, bytesImagen, estado);
+    llenarAleatorio(imagenes.M, bytesMascara, estado);
+}
+
+/**
+ * @brief Escribe un archivo M*.txt: la semilla y luego una tripleta RGB por linea.
+ *
+ * El texto se arma en memoria con `to_chars` y se escribe de una sola vez. Se borra
+ * el binario cacheado junto al archivo (si existe) porque ya no corresponde al texto.
+ */
+static bool escribirArchivoMascara(const QString& ruta, long long semilla, const unsigned int* valores, size_t numValores) {
+    string texto;
+    texto.reserve(24 + numValores * 4);
+
+    char numero[24];
+    to_chars_result r = to_chars(numero, numero + sizeof(numero), semilla);
+    texto.append(numero, r.ptr);
+    texto.push_back('\n');
+    for (size_t i = 0; i < numValores; i++) {
+        r = to_chars(numero, numero + sizeof(numero), valores[i]);
+        texto.append(numero, r.ptr);
+        texto.push_back(i % 3 == 2 ? '\n' : ' ');
+    }
+
+    QFile::remove(ruta + ".bin");
+    QSaveFile archivo(ruta);
+    if (!archivo.open(QIODevice::WriteOnly)) return false;
+    archivo.write(texto.data(), (qint64)texto.size());
+    return archivo.commit();
+}
+
+/**
+ * @brief Genera un caso completo en `directorio`: I_O, I_M, M, I_D y M1..Mn.txt.
+ *
+ * Con la convencion de la reconstruccion, P0 = I_O, cada etapa k aplica su operacion
+ * a P(k-1) y el archivo Mk.txt guarda la ventana de P(k-1) en su semilla sumada con M;
+ * I_D es la imagen tras la ultima etapa.
+ *
+ * Como todas las operaciones son byte a byte, la ventana de cada etapa se obtiene
+ * aplicando a la ventana de I_O solo las etapas anteriores, y I_D se calcula con toda
+ * la cadena compilada (`CompilarCadenaDirecta`) en una sola pasada por bloques sobre
+ * la imagen (`AplicarCadenaInversa`), sin guardar las imagenes intermedias.
+ *
+ * @return true Si se escribieron todos los archivos.
+ */
+static bool generarCaso(const QString& directorio, const OpcionesGenerador& opciones, unsigned long long estado) {
+    ImagenesCaso imagenes;
+    if (opciones.entrada.isEmpty()) {
+        generarImagenes(opciones, estado, imagenes);
+    } else if (!cargarImagenes(opciones.entrada, imagenes)) {
+        return false;
+    }
+
+    size_t totalBytes = (size_t)imagenes.width * imagenes.height * 3;
+    size_t maskSize = (size_t)imagenes.mask_width * imagenes.mask_height * 3;
+    if (maskSize == 0 || maskSize > totalBytes) {
+        salidaError() << "Error: la mascara debe ser mas pequeña que la imagen" << endl;
+        liberarImagenes(imagenes);
+        return false;
+    }
+
+    // Operaciones y semillas de cada etapa (las que no se indicaron son aleatorias)
+    int numEtapas = opciones.operaciones.empty() ? opciones.numEtapas : (int)opciones.operaciones.size();
+    vector<int> operations(numEtapas);
+    vector<long long> seeds(numEtapas);
+    for (int k = 0; k < numEtapas; k++) {
+        if (!opciones.operaciones.empty()) {
+            operations[k] = opciones.operaciones[k];
+        } else {
+            int tipo = (int)(siguienteAleatorio(estado) % 3);
+            int bits = 1 + (int)(siguienteAleatorio(estado) % (MAX_BITS - 1));
+            operations[k] = tipo == 0 ? 1 : (tipo == 1 ? 20 + bits : 30 + bits);
+        }
+        if (k < (int)opciones.semillas.size()) {
+            // La ventana de la mascara debe caber entera en la imagen
+            if ((unsigned long long)opciones.semillas[k] > totalBytes - maskSize) {
+                salidaError() << "Error: la semilla " << opciones.semillas[k] << " de la etapa " << k + 1
+                              << " (M" << k + 1 << ".txt) supera el maximo " << totalBytes - maskSize
+                              << " para una imagen de " << totalBytes << " bytes y una mascara de "
+                              << maskSize << endl;
+                liberarImagenes(imagenes);
+                return false;
+            }
+            seeds[k] = opciones.semillas[k];
+        } else {
+            seeds[k] = (long long)(siguienteAleatorio(estado) % (totalBytes - maskSize + 1));
+        }
+    }
+
+    if (!QDir().mkpath(directorio)) {
+        salidaError() << "Error: no se pudo crear " << directorio.toStdString() << endl;
+        liberarImagenes(imagenes);
+        return false;
+    }
+
+    bool exito = true;
+    PasoInverso* pasos = new PasoInverso[numEtapas > 0 ? numEtapas : 1];
+    unsigned char* ventana = new unsigned char[maskSize];
+    unsigned int* valores = new unsigned int[maskSize];
+
+    // 1. Ventanas de cada etapa: I_O con las etapas anteriores aplicadas, mas la mascara
+    for (int k = 0; k < numEtapas && exito; k++) {
+        size_t semilla = (size_t)seeds[k] < totalBytes ? (size_t)seeds[k] : totalBytes;
+        size_t longitud = totalBytes - semilla < maskSize ? totalBytes - semilla : maskSize;
+
+        int numPasos = CompilarCadenaDirecta(operations.data(), 0, k - 1, pasos);
+        AplicarCadenaInversa(imagenes.IO + semilla, imagenes.IM + semilla, ventana, longitud, pasos, numPasos);
+        for (size_t i = 0; i < longitud; i++) {
+            valores[i] = (unsigned int)ventana[i] + imagenes.M[i];
+        }
+
+        QString ruta = directorio + "M" + QString::number(k + 1) + ".txt";
+        if (!escribirArchivoMascara(ruta, seeds[k], valores, longitud - longitud % 3)) {
+            salidaError() << "Error: no se pudo escribir " << ruta.toStdString() << endl;
+            exito = false;
+        }
+    }
+
+    // Quitar archivos de etapas sobrantes de una generacion anterior
+    for (int k = numEtapas + 1; QFile::exists(directorio + "M" + QString::number(k) + ".txt"); k++) {
+        QString ruta = directorio + "M" + QString::number(k) + ".txt";
+        QFile::remove(ruta);
+        QFile::remove(ruta + ".bin");
+    }
+
+    // 2. I_D: toda la cadena en una sola pasada
+    if (exito) {
+        unsigned char* ID = new unsigned char[totalBytes];
+        int numPasos = CompilarCadenaDirecta(operations.data(), 0, numEtapas - 1, pasos);
+        AplicarCadenaInversaParalela(imagenes.IO, imagenes.IM, ID, totalBytes, pasos, numPasos);
+
+        exito = exportImage(ID, imagenes.width, imagenes.height, directorio + "I_D.bmp")
+             && exportImage(imagenes.IO, imagenes.width, imagenes.height, directorio + "I_O.bmp")
+             && exportImage(imagenes.IM, imagenes.width, imagenes.height, directorio + "I_M.bmp")
+             && exportImage(imagenes.M, imagenes.mask_width, imagenes.mask_height, directorio + "M.bmp");
+        delete[] ID;
+    }
+
+    if (exito) {
+        salida() << directorio.toStdString() << ": " << imagenes.width << "x" << imagenes.height
+                 << ", " << numEtapas << " etapas:";
+        for (int k = numEtapas - 1; k >= 0; k--) {
+            salida() << " " << operations[k];
+        }
+        salida() << " (de la ultima etapa a la primera)" << endl;
+    } else {
+        salidaError() << "Error al generar " << directorio.toStdString() << endl;
+    }
+
+    delete[] pasos;
+    delete[] ventana;
+    delete[] valores;
+    liberarImagenes(imagenes);
+    return exito;
+}
+
+// Lee una lista de enteros separados por comas
+template <typename T>
+static bool leerLista(const char* texto, vector<T>& lista) {
+    lista.clear();
+    const char* p = texto;
+    const char* fin = texto + strlen(texto);
+    while (p < fin) {
+        T valor;
+        from_chars_result r = from_chars(p, fin, valor);
+        if (r.ec != errc()) return false;
+        lista.push_back(valor);
+        p = r.ptr;
+        if (p < fin && *p != ',') return false;
+        if (p < fin) p++;
+    }
+    return !lista.empty();
+}
+
+static bool operacionValida(int operacion) {
+    int bits = operacion % 10;
+    return operacion == 1 || ((operacion / 10 == 2 || operacion / 10 == 3) && bits >= 1 && bits <= MAX_BITS);
+}
+
+static void mostrarUso(const char* programa) {
+    cout << "Uso: " << programa << " --salida DIR [opciones]" << endl;
+    cout << "  --salida DIR          Directorio del caso (o raiz de los casos con --casos)" << endl;
+    cout << "  --casos N             Generar N casos en DIR/caso0001, DIR/caso0002, ..." << endl;
+    cout << "  --entrada DIR         Usar I_O.bmp, I_M.bmp y M.bmp de DIR en lugar de datos sinteticos" << endl;
+    cout << "  --tamano WxH          Tamaño de las imagenes sinteticas (por defecto 640x480)" << endl;
+    cout << "  --mascara WxH         Tamaño de la mascara sintetica (por defecto 8x8)" << endl;
+    cout << "  --etapas N            Numero de etapas aleatorias (por defecto 6)" << endl;
+    cout << "  --operaciones A,B,..  Codigo de cada etapa en orden de aplicacion:" << endl;
+    cout << "                        1 = XOR, 2X = se deshace rotando X bits a la izquierda," << endl;
+    cout << "                        3X = se deshace rotando X bits a la derecha" << endl;
+    cout << "  --semillas A,B,..     Desplazamiento en bytes de la ventana de cada etapa" << endl;
+    cout << "  --aleatorio N         Semilla del generador pseudoaleatorio (por defecto 1)" << endl;
+}
+
+static bool leerTamano(const char* texto, int& ancho, int& alto) {
+    return sscanf(texto, "%dx%d", &ancho, &alto) == 2 && ancho > 0 && alto > 0;
+}
+
+int main(int argc, char* argv[]) {
+    OpcionesGenerador opciones;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool conValor = i + 1 < argc;
+        bool valido = conValor;
+        if (arg == "--salida" && conValor) {
+            opciones.salidaCasos = QDir::fromNativeSeparators(QString::fromLocal8Bit(argv[++i]));
+        } else if (arg == "--entrada" && conValor) {
+            opciones.entrada = QDir::fromNativeSeparators(QString::fromLocal8Bit(argv[++i]));
+            if (!opciones.entrada.endsWith('/')) opciones.entrada += '/';
+        } else if (arg == "--casos" && conValor) {
+            opciones.numCasos = atoi(argv[++i]);
+            valido = opciones.numCasos > 0;
+        } else if (arg == "--tamano" && conValor) {
+            valido = leerTamano(argv[++i], opciones.ancho, opciones.alto);
+        } else if (arg == "--mascara" && conValor) {
+            valido = leerTamano(argv[++i], opciones.mascaraAncho, opciones.mascaraAlto);
+        } else if (arg == "--etapas" && conValor) {
+            opciones.numEtapas = atoi(argv[++i]);
+            valido = opciones.numEtapas > 0;
+        } else if (arg == "--operaciones" && conValor) {
+            valido = leerLista(argv[++i], opciones.operaciones);
+            for (int operacion : opciones.operaciones) {
+                valido = valido && operacionValida(operacion);
+            }
+        } else if (arg == "--semillas" && conValor) {
+            valido = leerLista(argv[++i], opciones.semillas);
+            for (long long semilla : opciones.semillas) {
+                valido = valido && semilla >= 0;
+            }
+        } else if (arg == "--aleatorio" && conValor) {
+            opciones.semillaAleatoria = strtoull(argv[++i], nullptr, 10);
+        } else {
+            valido = false;
+        }
+
+        if (!valido) {
+            if (arg != "-h" && arg != "--help") cerr << "Opcion invalida: " << arg << endl;
+            mostrarUso(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (opciones.salidaCasos.isEmpty()) {
+        mostrarUso(argv[0]);
+        return 1;
+    }
+    if (!opciones.salidaCasos.endsWith('/')) opciones.salidaCasos += '/';
+
+    // Un caso por tarea; cada uno con su propia secuencia pseudoaleatoria
+    PoolHilos& pool = PoolHilos::global();
+    GrupoTareas casos;
+    vector<char> exitos(opciones.numCasos, 0);
+    for (int c = 0; c < opciones.numCasos; c++) {
+        QString directorio = opciones.salidaCasos;
+        if (opciones.numCasos > 1) {
+            directorio += QString("caso%1/").arg(c + 1, 4, 10, QChar('0'));
+        }
+        unsigned long long estado = (opciones.semillaAleatoria + c) * 0x9E3779B97F4A7C15ULL | 1;
+
+        pool.encolar(casos, [&, c, directorio, estado] {
+            // Los mensajes de cada caso se imprimen juntos al terminarlo
+            SalidaCaso salidaCaso;
+            {
+                AmbitoSalida ambito(&salidaCaso);
+                exitos[c] = generarCaso(directorio, opciones, estado);
+            }
+            ImprimirSalidaCaso(salidaCaso);
+        });
+    }
+    pool.esperar(casos);
+
+    int fallidos = 0;
+    for (char exito : exitos) {
+        if (!exito) fallidos++;
+    }
+    cout << "Casos generados: " << (opciones.numCasos - fallidos) << ", fallidos: " << fallidos << endl;
+    return fallidos == 0 ? 0 : 1;
+}
@@ -0,0 +1,43 @@
+# Generador de casos: aplica las etapas en sentido directo sobre I_O y escribe
+# I_D.bmp y M1..Mn.txt. Se compila aparte de BETA2.pro.
+
+QT += core gui
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG(release, debug|release): DEFINES += DESAFIO_SIN_DEPURACION
+win32: LIBS += -lpsapi
+TARGET = generador
+
+INCLUDEPATH += ..
+
+SOURCES += generador.cpp \
+    ../bmp.cpp \
+    ../exportacion.cpp \
+    ../hilos.cpp \
+    ../imagen.cpp \
+    ../memoria.cpp \
+    ../operaciones.cpp \
+    ../operaciones_paralelas.cpp \
+    ../operaciones_simd.cpp \
+    ../planificacion.cpp \
+    ../procesamiento.cpp \
+    ../recursos.cpp \
+    ../registro.cpp \
+    ../traza.cpp \
+    ../validacion.cpp
+
+HEADERS += \
+    ../bmp.h \
+    ../exportacion.h \
+    ../hilos.h \
+    ../imagen.h \
+    ../memoria.h \
+    ../operaciones.h \
+    ../operaciones_paralelas.h \
+    ../operaciones_simd.h \
+    ../planificacion.h \
+    ../procesamiento.h \
+    ../recursos.h \
+    ../registro.h \
+    ../traza.h \
+    ../validacion.h
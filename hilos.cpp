@@ -0,0 +1,167 @@
+#include "hilos.h"
+
+#include "registro.h"
+
+// Pool y cola del trabajador que corre en este hilo (nullptr / -1 fuera de un pool)
+static thread_local const PoolHilos* poolDelHilo = nullptr;
+static thread_local int indiceDelHilo = -1;
+
+/**
+ * @brief Crea el pool con `numHilos` trabajadores (al menos uno).
+ */
+PoolHilos::PoolHilos(int numHilos) {
+    if (numHilos < 1) numHilos = 1;
+    for (int i = 0; i < numHilos; i++) {
+        colas.emplace_back(new ColaTareas);
+    }
+    for (int i = 0; i < numHilos; i++) {
+        hilos.emplace_back(&PoolHilos::bucleTrabajador, this, i);
+    }
+}
+
+/**
+ * @brief Termina las tareas ya encoladas y detiene los trabajadores.
+ */
+PoolHilos::~PoolHilos() {
+    {
+        std::lock_guard<std::mutex> lock(cerrojoEspera);
+        detener = true;
+    }
+    hayTrabajo.notify_all();
+    for (std::thread& hilo : hilos) {
+        hilo.join();
+    }
+}
+
+/**
+ * @brief Pool compartido por todo el proceso, con un hilo por nucleo.
+ */
+PoolHilos& PoolHilos::global() {
+    static PoolHilos pool((int)std::thread::hardware_concurrency());
+    return pool;
+}
+
+int PoolHilos::indiceHiloActual() const {
+    return poolDelHilo == this ? indiceDelHilo : -1;
+}
+
+void PoolHilos::encolar(GrupoTareas& grupo, std::function<void()> tarea) {
+    grupo.pendientes.fetch_add(1);
+
+    int indice = indiceHiloActual();
+    ColaTareas& cola = indice >= 0 ? *colas[indice] : colaComun;
+    {
+        std::lock_guard<std::mutex> lock(cola.cerrojo);
+        cola.tareas.push_back(Tarea{&grupo, SalidaActual(), FaseMemoriaActual(), std::move(tarea)});
+    }
+    tareasEnCola.fetch_add(1);
+
+    {
+        // Tomar el cerrojo evita que un trabajador que se va a dormir pierda el aviso
+        std::lock_guard<std::mutex> lock(cerrojoEspera);
+    }
+    hayTrabajo.notify_one();
+    tareaTerminada.notify_all();
+}
+
+/**
+ * @brief Espera a que terminen las tareas del grupo y relanza la primera excepcion de ellas.
+ */
+void PoolHilos::esperar(GrupoTareas& grupo) {
+    int indice = indiceHiloActual();
+
+    while (grupo.pendientes.load() > 0) {
+        Tarea tarea;
+        if (tomarTarea(indice, tarea)) {
+            ejecutar(tarea);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(cerrojoEspera);
+        tareaTerminada.wait(lock, [&] { return grupo.pendientes.load() == 0 || tareasEnCola.load() > 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(grupo.cerrojoError);
+        std::swap(error, grupo.error);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+/**
+ * @brief Toma la siguiente tarea: primero la propia (LIFO), luego la comun y por ultimo roba (FIFO).
+ */
+bool PoolHilos::tomarTarea(int indice, Tarea& tarea) {
+    if (tareasEnCola.load() == 0) return false;
+
+    if (indice >= 0) {
+        ColaTareas& propia = *colas[indice];
+        std::lock_guard<std::mutex> lock(propia.cerrojo);
+        if (!propia.tareas.empty()) {
+            tarea = std::move(propia.tareas.back());
+            propia.tareas.pop_back();
+            tareasEnCola.fetch_sub(1);
+            return true;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(colaComun.cerrojo);
+        if (!colaComun.tareas.empty()) {
+            tarea = std::move(colaComun.tareas.front());
+            colaComun.tareas.pop_front();
+            tareasEnCola.fetch_sub(1);
+            return true;
+        }
+    }
+
+    int numColas = (int)colas.size();
+    int inicio = indice >= 0 ? indice + 1 : 0;
+    for (int i = 0; i < numColas; i++) {
+        ColaTareas& victima = *colas[(inicio + i) % numColas];
+        std::lock_guard<std::mutex> lock(victima.cerrojo);
+        if (!victima.tareas.empty()) {
+            tarea = std::move(victima.tareas.front());
+            victima.tareas.pop_front();
+            tareasEnCola.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Una excepcion de la tarea no sale del trabajador: se guarda en el grupo y la tarea
+// cuenta como terminada
+void PoolHilos::ejecutar(Tarea& tarea) {
+    try {
+        AmbitoSalida ambito(tarea.salida);
+        AmbitoMemoria fase(tarea.fase);
+        tarea.funcion();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(tarea.grupo->cerrojoError);
+        if (!tarea.grupo->error) tarea.grupo->error = std::current_exception();
+    }
+    tarea.grupo->pendientes.fetch_sub(1);
+    {
+        std::lock_guard<std::mutex> lock(cerrojoEspera);
+    }
+    tareaTerminada.notify_all();
+}
+
+void PoolHilos::bucleTrabajador(int indice) {
+    poolDelHilo = this;
+    indiceDelHilo = indice;
+
+    while (true) {
+        Tarea tarea;
+        if (tomarTarea(indice, tarea)) {
+            ejecutar(tarea);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(cerrojoEspera);
+        hayTrabajo.wait(lock, [&] { return detener || tareasEnCola.load() > 0; });
+        if (detener && tareasEnCola.load() == 0) return;
+    }
+}
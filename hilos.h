@@ -0,0 +1,85 @@
+#ifndef HILOS_H
+#define HILOS_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "memoria.h"
+
+class SalidaCaso;
+
+/**
+ * Conjunto de tareas encoladas juntas en un `PoolHilos`, para poder esperar
+ * solo por ellas. Si alguna lanza una excepcion, la primera se guarda y `esperar`
+ * la relanza cuando terminaron todas.
+ */
+struct GrupoTareas {
+    std::atomic<int> pendientes{0};
+    std::mutex cerrojoError;
+    std::exception_ptr error;
+};
+
+/**
+ * Pool de hilos de tamaño fijo con robo de trabajo.
+ *
+ * Cada trabajador tiene su propia cola: las tareas que encola un trabajador van a
+ * su cola y las toma en orden LIFO (datos aun en cache), mientras que los
+ * trabajadores sin trabajo roban de las colas ajenas en orden FIFO. Las tareas
+ * encoladas desde fuera del pool van a una cola comun.
+ *
+ * `esperar` bloquea hasta que terminen todas las tareas del grupo; mientras tanto el
+ * hilo que espera ejecuta tareas pendientes, por lo que se puede esperar desde
+ * dentro de una tarea sin bloquear el pool. Cada tarea escribe sus mensajes en la
+ * misma `SalidaCaso` que tenia activa quien la encolo, y sus asignaciones se
+ * atribuyen a la misma fase del perfil de memoria.
+ */
+class PoolHilos {
+public:
+    explicit PoolHilos(int numHilos);
+    ~PoolHilos();
+
+    PoolHilos(const PoolHilos&) = delete;
+    PoolHilos& operator=(const PoolHilos&) = delete;
+
+    void encolar(GrupoTareas& grupo, std::function<void()> tarea);
+    void esperar(GrupoTareas& grupo);
+    int numHilos() const { return (int)hilos.size(); }
+
+    static PoolHilos& global();
+
+private:
+    struct Tarea {
+        GrupoTareas* grupo;
+        SalidaCaso* salida;
+        FaseActualMemoria fase;
+        std::function<void()> funcion;
+    };
+
+    struct ColaTareas {
+        std::mutex cerrojo;
+        std::deque<Tarea> tareas;
+    };
+
+    int indiceHiloActual() const;
+    bool tomarTarea(int indice, Tarea& tarea);
+    void ejecutar(Tarea& tarea);
+    void bucleTrabajador(int indice);
+
+    std::vector<std::thread> hilos;
+    std::vector<std::unique_ptr<ColaTareas>> colas; // una por trabajador
+    ColaTareas colaComun;
+    std::atomic<int> tareasEnCola{0};
+    std::mutex cerrojoEspera;
+    std::condition_variable hayTrabajo;
+    std::condition_variable tareaTerminada;
+    bool detener = false;
+};
+
+#endif // HILOS_H
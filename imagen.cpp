@@ -0,0 +1,45 @@
+#include "imagen.h"
+#include <new>
+
+using namespace std;
+
+/**
+ * @brief Reserva una imagen de `ancho`x`alto` pixeles sin inicializar.
+ *
+ * Con dimensiones no positivas la imagen queda vacia.
+ */
+Imagen::Imagen(int ancho, int alto, int canales) {
+    if (ancho <= 0 || alto <= 0 || canales <= 0) return;
+    anchoImagen = ancho;
+    altoImagen = alto;
+    numCanales = canales;
+    pixeles = (unsigned char*)operator new[](bytes(), align_val_t(ALINEACION_IMAGEN));
+}
+
+Imagen::~Imagen() {
+    liberar();
+}
+
+Imagen::Imagen(Imagen&& otra) noexcept
+    : pixeles(otra.pixeles), anchoImagen(otra.anchoImagen), altoImagen(otra.altoImagen), numCanales(otra.numCanales) {
+    otra.pixeles = nullptr;
+    otra.anchoImagen = otra.altoImagen = 0;
+}
+
+Imagen& Imagen::operator=(Imagen&& otra) noexcept {
+    if (this != &otra) {
+        liberar();
+        pixeles = otra.pixeles;
+        anchoImagen = otra.anchoImagen;
+        altoImagen = otra.altoImagen;
+        numCanales = otra.numCanales;
+        otra.pixeles = nullptr;
+        otra.anchoImagen = otra.altoImagen = 0;
+    }
+    return *this;
+}
+
+void Imagen::liberar() {
+    if (pixeles) operator delete[](pixeles, align_val_t(ALINEACION_IMAGEN));
+    pixeles = nullptr;
+}
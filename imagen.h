@@ -0,0 +1,107 @@
+#ifndef IMAGEN_H
+#define IMAGEN_H
+
+#include <cstddef>
+
+// Alineacion del buffer de una `Imagen`: una linea de cache y un registro AVX-512
+const size_t ALINEACION_IMAGEN = 64;
+
+/**
+ * Vista no propietaria sobre pixeles en formato interno (canales empaquetados, fila
+ * superior primero). Copiarla no copia pixeles.
+ *
+ * `stride` es la distancia en bytes entre el inicio de dos filas; es igual a
+ * `ancho * canales` salvo en subregiones, cuyas filas no son contiguas. `T` es
+ * `unsigned char` (`VistaImagen`, se puede escribir) o `const unsigned char`
+ * (`VistaLectura`); una vista de escritura se convierte sola en una de lectura.
+ */
+template <class T>
+struct VistaImagenBase {
+    T* datos = nullptr;
+    int ancho = 0;
+    int alto = 0;
+    int canales = 3;
+    size_t stride = 0;
+
+    VistaImagenBase() = default;
+    VistaImagenBase(T* datos, int ancho, int alto, int canales = 3)
+        : datos(datos), ancho(ancho), alto(alto), canales(canales), stride((size_t)ancho * canales) {}
+    VistaImagenBase(T* datos, int ancho, int alto, int canales, size_t stride)
+        : datos(datos), ancho(ancho), alto(alto), canales(canales), stride(stride) {}
+
+    template <class U>
+    VistaImagenBase(const VistaImagenBase<U>& otra)
+        : datos(otra.datos), ancho(otra.ancho), alto(otra.alto), canales(otra.canales), stride(otra.stride) {}
+
+    bool vacia() const { return !datos || ancho <= 0 || alto <= 0; }
+    size_t bytesFila() const { return (size_t)ancho * canales; }
+    size_t bytes() const { return bytesFila() * (alto > 0 ? alto : 0); }
+    bool contigua() const { return stride == bytesFila() || alto <= 1; }
+    T* fila(int y) const { return datos + (size_t)y * stride; }
+
+    // Filas [fila, fila + numFilas), recortadas a la imagen
+    VistaImagenBase filas(int fila, int numFilas) const {
+        if (fila < 0) fila = 0;
+        if (fila > alto) fila = alto;
+        if (numFilas > alto - fila) numFilas = alto - fila;
+        return VistaImagenBase(datos + (size_t)fila * stride, ancho, numFilas > 0 ? numFilas : 0, canales, stride);
+    }
+
+    // Rectangulo de `w`x`h` pixeles con esquina superior izquierda en (x, y); no es contigua
+    VistaImagenBase subregion(int x, int y, int w, int h) const {
+        if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > ancho || y + h > alto) return VistaImagenBase();
+        return VistaImagenBase(datos + (size_t)y * stride + (size_t)x * canales, w, h, canales, stride);
+    }
+
+    // `longitud` bytes a partir del byte `inicio` (en orden de filas), como una fila de un canal.
+    // Es la ventana de una semilla; solo tiene sentido en vistas contiguas.
+    VistaImagenBase ventana(size_t inicio, size_t longitud) const {
+        size_t total = bytes();
+        if (!contigua() || inicio > total) return VistaImagenBase();
+        if (longitud > total - inicio) longitud = total - inicio;
+        return VistaImagenBase(datos + inicio, (int)longitud, 1, 1, longitud);
+    }
+};
+
+using VistaImagen = VistaImagenBase<unsigned char>;
+using VistaLectura = VistaImagenBase<const unsigned char>;
+
+/**
+ * Imagen propietaria de sus pixeles, con el buffer alineado a `ALINEACION_IMAGEN` bytes
+ * y filas empaquetadas (`stride == ancho * canales`).
+ *
+ * Solo se mueve, no se copia: para trabajar sobre una parte se usa una vista.
+ */
+class Imagen {
+public:
+    Imagen() = default;
+    Imagen(int ancho, int alto, int canales = 3);
+    ~Imagen();
+
+    Imagen(Imagen&& otra) noexcept;
+    Imagen& operator=(Imagen&& otra) noexcept;
+    Imagen(const Imagen&) = delete;
+    Imagen& operator=(const Imagen&) = delete;
+
+    unsigned char* datos() { return pixeles; }
+    const unsigned char* datos() const { return pixeles; }
+    int ancho() const { return anchoImagen; }
+    int alto() const { return altoImagen; }
+    int canales() const { return numCanales; }
+    size_t stride() const { return (size_t)anchoImagen * numCanales; }
+    size_t bytes() const { return stride() * altoImagen; }
+    bool vacia() const { return pixeles == nullptr; }
+
+    VistaImagen vista() { return VistaImagen(pixeles, anchoImagen, altoImagen, numCanales); }
+    VistaLectura vista() const { return VistaLectura(pixeles, anchoImagen, altoImagen, numCanales); }
+
+private:
+    void liberar();
+
+    unsigned char* pixeles = nullptr;
+    int anchoImagen = 0;
+    int altoImagen = 0;
+    int numCanales = 3;
+};
+
+#endif // IMAGEN_H
@@ -0,0 +1,47 @@
+# Biblioteca de reconstruccion (libdesafio): la API de desafio.h, que trabaja sobre
+# buffers en memoria y no lee ni escribe archivos. BETA2.pro la compila antes que la
+# aplicacion, que la enlaza. Por defecto es estatica; con CONFIG+=desafio_compartida
+# (compilando solo este proyecto) se genera la compartida.
+
+TEMPLATE = lib
+QT += core
+QT -= gui
+CONFIG += c++17
+CONFIG(release, debug|release): DEFINES += DESAFIO_SIN_DEPURACION
+win32: LIBS += -lpsapi
+TARGET = desafio
+
+desafio_compartida {
+    CONFIG += shared hide_symbols
+    DEFINES += DESAFIO_BIBLIOTECA_COMPARTIDA DESAFIO_CONSTRUYENDO
+} else {
+    CONFIG += staticlib
+}
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    ../desafio.cpp \
+    ../hilos.cpp \
+    ../imagen.cpp \
+    ../memoria.cpp \
+    ../operaciones.cpp \
+    ../operaciones_paralelas.cpp \
+    ../operaciones_simd.cpp \
+    ../planificacion.cpp \
+    ../registro.cpp \
+    ../traza.cpp \
+    ../validacion.cpp
+
+HEADERS += \
+    ../desafio.h \
+    ../hilos.h \
+    ../imagen.h \
+    ../memoria.h \
+    ../operaciones.h \
+    ../operaciones_paralelas.h \
+    ../operaciones_simd.h \
+    ../planificacion.h \
+    ../registro.h \
+    ../traza.h \
+    ../validacion.h
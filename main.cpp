@@ -1,148 +1,151 @@
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <vector>
 #include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
 #include <QImage>
+#include <QStringList>
 
-#include "operaciones.h"
+#include "bmp.h"
+#include "desafio.h"
 #include "validacion.h"
 #include "procesamiento.h"
+#include "reanudacion.h"
+#include "recursos.h"
+#include "hilos.h"
+#include "exportacion.h"
+#include "memoria.h"
+#include "registro.h"
+#include "servidor.h"
+#include "traza.h"
 
 using namespace std;
 
+// Opciones de una ejecucion de reconstruccion
+struct OpcionesReconstruccion {
+    bool modoPlanificado = false;    // detectar sobre ventanas y aplicar la cadena en una pasada
+    bool exportarIntermedias = true; // guardar P*.bmp y P*_reconstruida.bmp de cada etapa
+    int filasPorBanda = 0;           // > 0: procesar por bandas de filas sin cargar las imagenes completas
+    bool reanudar = true;            // continuar desde reanudacion.txt si sus digestos coinciden
+};
+
+// Imagenes y datos de enmascaramiento de un caso cargados en memoria
+struct DatosCaso {
+    QString rutaBase;
+    int numEtapas = 0;
+    int width = 0, height = 0, mask_width = 0, mask_height = 0;
+    // Vistas de solo lectura sobre los recursos compartidos de abajo
+    const unsigned char *ID = nullptr, *IM = nullptr, *M = nullptr;
+    vector<DesafioEtapa> etapas;  // datos de M(i+1).txt para cada etapa i
+    // Recursos del `AlmacenRecursos`: mantienen vivas las vistas mientras se use el caso
+    shared_ptr<const Imagen> imagenID, imagenIM, imagenM;
+    vector<shared_ptr<const MascaraCargada>> mascaras;
+    // Puntos de control (modo por etapas con intermedias). Si se reanuda, las primeras
+    // `etapasCompletadas` etapas guardadas ya estan aplicadas e ID es la imagen que dejaron.
+    shared_ptr<PuntosControl> puntosControl;
+    int etapasCompletadas = 0;
+};
+
 // Prototipos de funciones
-int DeterminarOperacionInversa(unsigned char* actualIMG, unsigned char* IM, unsigned char* M, unsigned int* datosMascara, int semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto);
-bool cargarDatosBase(const QString& rutaBase, int& anchoIMG, int& altoIMG, int& mask_ancho, int& mask_alto, unsigned char*& ID, unsigned char*& IM, unsigned char*& IO, unsigned char*& M);
-bool cargarDatosEnmascaramiento(const QString& rutaBase, int numEtapas, unsigned int**& datosMascara, int*& semilla, int*& numPixels);
-unsigned char* aplicarOperacionInversa(unsigned char* actualIMG, unsigned char* IM, int operation, int anchoIMG, int altoIMG);
-bool procesarEtapa(int etapa, int numEtapas, unsigned char*& currentImg,unsigned char* ID, unsigned char* IO, unsigned char* IM, unsigned char* M, unsigned int** maskingData, int* seeds, int width, int height, int mask_width, int mask_height, int* operations, const QString& rutaBase);
-void reconstruirImagen(const QString& rutaBase, int numEtapas);
+bool cargarDatosBase(const QString& rutaBase, const QString& archivoID, int& anchoIMG, int& altoIMG, int& mask_ancho, int& mask_alto, shared_ptr<const Imagen>& ID, shared_ptr<const Imagen>& IM, shared_ptr<const Imagen>& M);
+bool cargarDatosEnmascaramiento(const QString& rutaBase, int numEtapas, vector<shared_ptr<const MascaraCargada>>& mascaras, vector<DesafioEtapa>& etapas);
+void procesarEtapa(int etapa, int operacion, const unsigned char* pixeles, void* contexto);
+void reenviarMensaje(const char* linea, void* contexto);
+bool cargarCaso(DatosCaso& datos, const OpcionesReconstruccion& opciones);
+void liberarCaso(DatosCaso& datos);
+int detectarNumEtapas(const QString& rutaBase);
+bool reconstruirCaso(const DatosCaso& datos, const OpcionesReconstruccion& opciones);
+bool reconstruirPorBandas(const QString& rutaBase, int numEtapas, const OpcionesReconstruccion& opciones);
+void mostrarResumenOperaciones(const int* operations, int numEtapas);
+void mostrarVerificacion(const VerificacionReconstruccion& verificacion);
+bool reconstruirImagen(const QString& rutaBase, int numEtapas, const OpcionesReconstruccion& opciones);
+int procesarLote(const QStringList& rutas, int etapasForzadas, const OpcionesReconstruccion& opciones);
 
 // Implementacion de funciones
 
 /**
- * @brief Determina que operacion inversa fue aplicada a una imagen distorsionada.
- *
- * Esta funcion intenta deducir que tipo de operacion fue utilizada para distorsionar una imagen
- * comparando la imagen actual con varias versiones generadas a partir de la mascara.
- * Evalua primero XOR, luego rotaciones hacia la izquierda y derecha de 1 a MAX_BITS (8) bits.
- *
- * @param actualIMG Puntero a la imagen distorsionada actual.
- * @param IM Puntero a la imagen para aplicar XOR.
- * @param M Puntero a la imagen de mascara.
- * @param datosMascara Puntero a datos auxiliares de la mascara.
- * @param semilla Semilla utilizada para reproducir la operacion (por ejemplo, en PRNGs).
- * @param anchoIMG Ancho de la imagen en pixeles.
- * @param altoIMG Alto de la imagen en pixeles.
- * @param mask_ancho Ancho de la mascara en pixeles.
- * @param mask_alto Alto de la mascara en pixeles.
- *
- * @return int Codigo que representa la operacion inversa detectada:
- *         - 1  → Operacion XOR.
- *         - 2X → Rotacion a la izquierda de X bits.
- *         - 3X → Rotacion a la derecha de X bits.
- *         - -1 → No se pudo determinar la operacion.
- *
- * @see validarXOR, validarRotarIzquierda, validarRotarDerecha
- */
-
-int DeterminarOperacionInversa(unsigned char* actualIMG, unsigned char* IM, unsigned char* M, unsigned int* datosMascara, int semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto) {
-
-    // 1. Validar XOR primero (operacion mas comun)
-    cout << "Validando operacion XOR..." << endl;
-    if (validarXOR(actualIMG, IM, M, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto)) {
-        cout << "Operacion XOR validada correctamente" << endl;
-        return 1; // Codigo para XOR
-    }
-
-    // 2. Validar rotaciones (de 1 a MAX_BITS bits)
-    cout << "Validando operaciones de rotacion..." << endl;
-    for (int bits = 1; bits <= MAX_BITS; bits++) {
-        // Rotacion izquierda (inverso de rotacion derecha original)
-        cout << "Validando rotacion izquierda de " << bits << " bits..." << endl;
-        if (validarRotarIzquierda(actualIMG, M, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto, bits)) {
-            cout << "Rotacion izquierda de " << bits << " bits validada" << endl;
-            return 20 + bits; // Codigo 2X para rotacion izquierda (X = bits)
-        }
-
-        // Rotacion derecha (inverso de rotacion izquierda original)
-        cout << "Validando rotacion derecha de " << bits << " bits..." << endl;
-        if (validarRotarDerecha(actualIMG, M, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto, bits)) {
-            cout << "Rotacion derecha de " << bits << " bits validada" << endl;
-            return 30 + bits; // Codigo 3X para rotacion derecha (X = bits)
-        }
-    }
-
-    // 3. Si no se valido ninguna operacion
-    cerr << "Error: No se pudo determinar la operacion inversa" << endl;
-    return -1;
-}
-
-/**
- * @brief Carga las imagenes necesarias desde disco para procesar la reconstruccion o analisis.
+ * @brief Obtiene las imagenes necesarias para procesar la reconstruccion o analisis.
  *
- * Esta funcion carga las imagenes involucradas en la transformacion:
+ * Esta funcion pide al almacen de recursos las imagenes involucradas en la transformacion:
  * - M: Imagen de mascara.
  * - I_M: Imagen para aplicar XOR.
  * - I_D: Imagen distorsionada.
- * - I_O: Imagen original sin modificar.
  *
- * Verifica que cada imagen se haya cargado correctamente y que las dimensiones sean validas.
+ * I_O.bmp no se carga aqui: solo la usa `VerificarReconstruccion`, que la pide al terminar.
+ * Las tres imagenes se decodifican en paralelo en el pool global de hilos (o se reutilizan
+ * si ya estaban cargadas). Verifica que cada imagen se haya cargado correctamente y que las
+ * dimensiones sean validas.
  *
  * @param rutaBase Ruta base donde se encuentran las imagenes.
  * @param anchoIMG Referencia al ancho de las imagenes base.
  * @param altoIMG Referencia al alto de las imagenes base.
  * @param mask_ancho Referencia al ancho de la imagen de mascara.
  * @param mask_alto Referencia al alto de la imagen de mascara.
- * @param ID Referencia al puntero que contendra la imagen distorsionada.
- * @param IM Referencia al puntero que contendra la imagen para aplicar operacion XOR.
- * @param IO Referencia al puntero que contendra la imagen original.
- * @param M Referencia al puntero que contendra la mascara.
+ * @param ID Recurso que contendra la imagen distorsionada.
+ * @param IM Recurso que contendra la imagen para aplicar operacion XOR.
+ * @param M Recurso que contendra la mascara.
  *
  * @return true Si todas las imagenes fueron cargadas exitosamente y las dimensiones son validas.
- * @return false Si ocurrio algun error al cargar una o mas imagenes.
+ * @return false Si ocurrio algun error al cargar una o mas imagenes (no se conserva ningun recurso).
  *
- * @see loadPixels
+ * @see AlmacenRecursos
  */
 
-bool cargarDatosBase(const QString& rutaBase, int& anchoIMG, int& altoIMG, int& mask_ancho, int& mask_alto, unsigned char*& ID, unsigned char*& IM, unsigned char*& IO, unsigned char*& M) {
-    // Cargar imagen mascara M
+bool cargarDatosBase(const QString& rutaBase, const QString& archivoID, int& anchoIMG, int& altoIMG, int& mask_ancho, int& mask_alto, shared_ptr<const Imagen>& ID, shared_ptr<const Imagen>& IM, shared_ptr<const Imagen>& M) {
     QString mascaraPath = rutaBase + "M.bmp";
-    cout << "Cargar mascara M : M.bmp" << endl;
-    M = loadPixels(mascaraPath, mask_ancho, mask_alto);
-
-    if (!M || mask_ancho == 0 || mask_alto == 0) {
-        cerr << "Error: No se pudo cargar la mascara M o dimensiones invalidas" << endl;
+    QString imPath = rutaBase + "I_M.bmp";
+    QString idPath = rutaBase + archivoID;
+
+    REGISTRO_DEPURACION << "Cargar mascara M : M.bmp\n"
+                        << "Imagen para XOR IM : I_M.bmp\n"
+                        << "Imagen original distorcionada ID : " << archivoID.toStdString() << '\n';
+
+    // Las tres imagenes son independientes: se decodifican en paralelo
+    AlmacenRecursos& almacen = AlmacenRecursos::global();
+    PoolHilos& pool = PoolHilos::global();
+    GrupoTareas carga;
+    pool.encolar(carga, [&] { M = almacen.imagen(mascaraPath); });
+    pool.encolar(carga, [&] { IM = almacen.imagen(imPath); });
+    pool.encolar(carga, [&] { ID = almacen.imagen(idPath); });
+    pool.esperar(carga);
+
+    if (!M || M->ancho() == 0 || M->alto() == 0) {
+        salidaError() << "Error: No se pudo cargar la mascara M o dimensiones invalidas\n";
+        ID.reset();
+        IM.reset();
+        M.reset();
+        return false;
+    }
+    mask_ancho = M->ancho();
+    mask_alto = M->alto();
+    salida() << "Mascara M cargada correctamente. Dimensiones: "
+         << mask_ancho << "x" << mask_alto << '\n';
+
+    if (!IM || !ID) {
+        salidaError() << "Error al cargar imagenes base\n";
+        ID.reset();
+        IM.reset();
+        M.reset();
         return false;
     }
-    cout << "Mascara M cargada correctamente. Dimensiones: "
-         << mask_ancho << "x" << mask_alto << endl;
-
-    // Cargar imagenes base
-    QString imPath = rutaBase + "I_M.bmp";
-    QString idPath = rutaBase + "I_D.bmp";
-    QString ioPath = rutaBase + "I_O.bmp";
-
-    cout << "Imagen para XOR IM : I_M.bmp" << endl;
-    IM = loadPixels(imPath, anchoIMG, altoIMG);
-
-    cout << "Imagen original distorcionada ID : I_D.bmp" << endl;
-    ID = loadPixels(idPath, anchoIMG, altoIMG);
-
-    cout << "Imagen original IO : I_O.bmp" << endl;
-    IO = loadPixels(ioPath, anchoIMG, altoIMG);
-
 
-    if (!IM || !ID || !IO) {
-        cerr << "Error al cargar imagenes base" << endl;
-        if (IM) delete[] IM;
-        if (ID) delete[] ID;
-        if (IO) delete[] IO;
-        if (M) delete[] M;
+    if (IM->ancho() != ID->ancho() || IM->alto() != ID->alto()) {
+        salidaError() << "Error: las imagenes base no tienen las mismas dimensiones\n";
+        ID.reset();
+        IM.reset();
+        M.reset();
         return false;
     }
+    anchoIMG = ID->ancho();
+    altoIMG = ID->alto();
 
-    cout << "Imagenes base cargadas correctamente. Dimensiones: "
-         << anchoIMG << "x" << altoIMG << endl;
+    salida() << "Imagenes base cargadas correctamente. Dimensiones: "
+         << anchoIMG << "x" << altoIMG << '\n';
 
     return true;
 }
@@ -150,299 +153,917 @@ bool cargarDatosBase(const QString& rutaBase, int& anchoIMG, int& altoIMG, int&
 /**
  * @brief Carga los archivos de datos de enmascaramiento para multiples etapas.
  *
- * Esta funcion lee archivos de texto con extension `.txt` que contienen los datos
- * de enmascaramiento necesarios para aplicar o revertir operaciones sobre imagenes.
- * Asigna dinamicamente memoria para almacenar:
- * - Los datos de la mascara (`datosMascara`)
- * - Las semillas asociadas a cada etapa (`semilla`)
- * - El numero de pixeles utilizados en cada etapa (`numPixels`)
+ * Esta funcion pide al almacen de recursos los archivos de texto con extension `.txt`
+ * que contienen los datos de enmascaramiento necesarios para aplicar o revertir
+ * operaciones sobre imagenes, y arma con ellos las etapas en la forma que recibe la
+ * biblioteca (`DesafioEtapa`: sumas esperadas, numero de pixeles y semilla).
+ *
+ * Los archivos se cargan en paralelo en el pool global de hilos. Las etapas no copian
+ * los datos: `sumas` apunta dentro de `mascaras`, que debe seguir vivo mientras se usen.
  *
  * @param rutaBase Ruta base donde se encuentran los archivos.
  * @param numEtapas Numero total de etapas o archivos a cargar (ej. M1.txt, M2.txt, ...).
- * @param datosMascara Referencia a un puntero doble que almacenara los datos por etapa.
- * @param semilla Referencia a un arreglo que contendra las semillas asociadas a cada etapa.
- * @param numPixels Referencia a un arreglo que contendra el numero de pixeles por etapa.
+ * @param mascaras Recursos cargados por etapa (mantienen vivos los datos).
+ * @param etapas Recibe una entrada por etapa; `etapas[i]` corresponde a M(i+1).txt.
  *
  * @return true Si todos los archivos fueron cargados correctamente.
- * @return false Si alguno de los archivos no pudo ser cargado (libera memoria asignada).
+ * @return false Si alguno de los archivos no pudo ser cargado (se vacia `mascaras`).
  *
- * @see loadSeedMasking
+ * @see AlmacenRecursos, loadSeedMasking
  */
 
-bool cargarDatosEnmascaramiento(const QString& rutaBase, int numEtapas, unsigned int**& datosMascara, int*& semilla, int*& numPixels) {
+bool cargarDatosEnmascaramiento(const QString& rutaBase, int numEtapas, vector<shared_ptr<const MascaraCargada>>& mascaras, vector<DesafioEtapa>& etapas) {
+    mascaras.assign(numEtapas, nullptr);
 
-    datosMascara = new unsigned int*[numEtapas];
-    semilla = new int[numEtapas];
-    numPixels = new int[numEtapas];
+    // Cada archivo se carga en su propia tarea del pool
+    AlmacenRecursos& almacen = AlmacenRecursos::global();
+    PoolHilos& pool = PoolHilos::global();
+    GrupoTareas carga;
+    for (int i = 0; i < numEtapas; i++) {
+        pool.encolar(carga, [&, i] {
+            mascaras[i] = almacen.mascara(rutaBase + "M" + QString::number(i+1) + ".txt");
+        });
+    }
+    pool.esperar(carga);
 
     for (int i = 0; i < numEtapas; i++) {
-        QString filename = rutaBase + "M" + QString::number(i+1) + ".txt";
-        datosMascara[i] = loadSeedMasking(filename.toStdString().c_str(), semilla[i], numPixels[i]);
-
-        if (!datosMascara[i]) {
-            cerr << "Error al cargar archivo de enmascaramiento " << i+1 << endl;
-            // Limpiar memoria ya asignada
-            for (int j = 0; j < i; j++) delete[] datosMascara[j];
-            delete[] datosMascara;
-            delete[] semilla;
-            delete[] numPixels;
+        if (!mascaras[i]) {
+            salidaError() << "Error al cargar archivo de enmascaramiento " << i+1 << '\n';
+            mascaras.clear();
             return false;
         }
     }
+
+    etapas.resize(numEtapas);
+    for (int i = 0; i < numEtapas; i++) {
+        etapas[i].sumas = mascaras[i]->datos;
+        etapas[i].numPixeles = mascaras[i]->numPixeles;
+        etapas[i].semilla = mascaras[i]->semilla;
+    }
     return true;
 }
 
+// Lo que necesitan las devoluciones de llamada de la biblioteca durante un caso
+struct ContextoBiblioteca {
+    const DatosCaso* datos = nullptr;
+    ExportadorAsincrono* exportador = nullptr;  // nullptr: sin imagenes intermedias
+    SalidaCaso* salidaCaso = nullptr;           // destino de mensajes de quien llamo a la biblioteca
+};
+
 /**
- * @brief Aplica la operacion inversa a una imagen distorsionada, dependiendo del tipo de transformacion detectada.
+ * @brief Guarda el resultado de una etapa que acaba de deshacer la biblioteca.
  *
- * Esta funcion realiza la operacion inversa sobre una imagen `actualIMG`, utilizando
- * informacion de la imagen `IM` y el codigo de operacion proporcionado. Soporta:
- * - XOR inverso (usando la misma imagen XOR).
- * - Rotacion izquierda (para revertir rotaciones derechas).
- * - Rotacion derecha (para revertir rotaciones izquierdas).
+ * Se registra como `DesafioOpciones::etapaAplicada`. Las imagenes intermedias se
+ * encolan en el exportador (que copia los pixeles) y se escriben en segundo plano:
+ * P(etapa)_reconstruida.bmp y, si queda otra etapa, la misma imagen como P(etapa).bmp,
+ * que es la entrada de la siguiente.
  *
- * @param actualIMG Puntero a la imagen distorsionada.
- * @param IM Puntero a la imagen auxiliar utilizada para revertir la operacion (solo para XOR).
- * @param operation Codigo de operacion inversa detectado (por ejemplo, 1 para XOR, 22 para rotacion izq. de 2 bits).
- * @param anchoIMG Ancho de la imagen en pixeles.
- * @param altoIMG Alto de la imagen en pixeles.
+ * @param etapa Indice de la etapa aplicada (en orden inverso).
+ * @param operacion Codigo de la operacion detectada.
+ * @param pixeles Imagen que dejo la etapa; solo vale durante la llamada.
+ * @param contexto `ContextoBiblioteca` del caso.
  *
- * @return unsigned char* Puntero a la imagen resultante tras aplicar la operacion inversa.
- *
- * @see DoXOR, RotarIzquierda, RotarDerecha
+ * @see desafio_reconstruir, PuntosControl::registrar, ExportadorAsincrono
  */
 
-unsigned char* aplicarOperacionInversa(unsigned char* actualIMG, unsigned char* IM, int operation, int anchoIMG, int altoIMG) {
-    unsigned char* result = nullptr;
+void procesarEtapa(int etapa, int operacion, const unsigned char* pixeles, void* contexto) {
+    AmbitoMemoria fase(FASE_EXPORTACION);
+    const ContextoBiblioteca& biblioteca = *static_cast<const ContextoBiblioteca*>(contexto);
+    const DatosCaso& datos = *biblioteca.datos;
+    int numEtapas = datos.numEtapas;
 
-    switch (operation / 10) {
-    case 0: // XOR
-        cout << "Aplicando XOR inverso" << endl;
-        result = DoXOR(actualIMG, IM, anchoIMG, altoIMG);
-        break;
+    salida() << "=== ETAPA " << (numEtapas - etapa) << "/" << numEtapas << " COMPLETADA: ";
+    printOperationDescription(operacion);
+    salida() << " ===\n";
 
-    case 2: // Rotacion derecha original → izquierda inversa
-        cout << "Aplicando rotacion izquierda de " << operation%10 << " bits" << endl;
-        result = RotarIzquierda(actualIMG, anchoIMG * altoIMG, operation%10);
-        break;
+    ExportadorAsincrono* exportador = biblioteca.exportador;
+    if (!exportador) return;
 
-    case 3: // Rotacion izquierda original → derecha inversa
-        cout << "Aplicando rotacion derecha de " << operation%10 << " bits" << endl;
-        result = RotarDerecha(actualIMG, anchoIMG * altoIMG, operation%10);
-        break;
+    QString reconstruida = QString("P%1_reconstruida.bmp").arg(etapa);
+    exportador->encolar(pixeles, datos.width, datos.height, datos.rutaBase + reconstruida);
+    if (etapa > 0) {
+        exportador->encolar(pixeles, datos.width, datos.height, datos.rutaBase + QString("P%1.bmp").arg(etapa));
+    }
 
-    default:
-        cerr << "Operacion desconocida: " << operation << endl;
-        break;
+    // Punto de control: una ejecucion posterior puede continuar desde esta imagen
+    if (datos.puntosControl && !datos.puntosControl->registrar(etapa, operacion, reconstruida, pixeles, (size_t)datos.width * datos.height * 3)) {
+        REGISTRO_AVISO << "Aviso: no se pudo guardar el punto de control de la etapa " << (numEtapas - etapa) << '\n';
     }
+}
 
-    return result;
+/**
+ * @brief Reenvia una linea de mensajes de la biblioteca al destino del caso (o a la consola).
+ *
+ * Se registra como `DesafioOpciones::mensaje`. Durante la llamada la salida del hilo es
+ * la de la biblioteca, por eso se escribe directamente en el destino guardado.
+ */
+
+void reenviarMensaje(const char* linea, void* contexto) {
+    SalidaCaso* destino = static_cast<const ContextoBiblioteca*>(contexto)->salidaCaso;
+    if (destino) {
+        ostream flujo(destino);
+        flujo << linea << '\n';
+    } else {
+        cout << linea << '\n';
+    }
 }
 
 /**
- * @brief Procesa una etapa de reconstruccion aplicando la operacion inversa correspondiente.
- *
- * Esta funcion guarda la imagen actual, determina que operacion de distorsion fue aplicada en la etapa,
- * aplica la operacion inversa, actualiza la imagen y guarda una reconstruccion intermedia.
- *
- * @param etapa indice de la etapa actual (en orden inverso).
- * @param numEtapas Numero total de etapas de enmascaramiento.
- * @param currentImg Imagen actual que se esta reconstruyendo (actualizada por referencia).
- * @param ID Imagen distorsionada original.
- * @param IO Imagen original sin modificar.
- * @param IM Imagen utilizada para operaciones XOR.
- * @param M Imagen de mascara (BMP).
- * @param maskingData Arreglo doble con los datos de enmascaramiento por etapa.
- * @param seeds Arreglo de semillas utilizadas en cada etapa.
- * @param width Ancho de la imagen.
- * @param height Alto de la imagen.
- * @param mask_width Ancho de la mascara.
- * @param mask_height Alto de la mascara.
- * @param operations Arreglo para almacenar las operaciones detectadas.
- * @param rutaBase Ruta base donde se guardaran las imagenes intermedias.
- *
- * @return true Si la operacion inversa fue aplicada y la imagen reconstruida correctamente.
- * @return false Si ocurre un error durante el procesamiento o deteccion de la operacion.
- *
- * @see DeterminarOperacionInversa, aplicarOperacionInversa, exportImage
+ * @brief Carga en memoria todo lo que necesita un caso: imagenes base y datos de enmascaramiento.
+ *
+ * En el modo por etapas con intermedias abre tambien los puntos de control del caso y,
+ * si hay etapas guardadas validas, carga como ID la imagen que dejo la ultima.
+ *
+ * @param datos Caso a cargar; `rutaBase` y `numEtapas` deben venir completos.
+ * @param opciones Modo de reconstruccion (decide si hay puntos de control y si se reanuda).
+ *
+ * @return true Si todo se cargo; false si algo fallo (no queda memoria reservada).
+ *
+ * @see cargarDatosBase, cargarDatosEnmascaramiento, liberarCaso
  */
 
-bool procesarEtapa(int etapa, int numEtapas, unsigned char*& currentImg, unsigned char* ID, unsigned char* IO, unsigned char* IM, unsigned char* M, unsigned int** maskingData, int* seeds, int width, int height, int mask_width, int mask_height, int* operations, const QString& rutaBase) {
+bool cargarCaso(DatosCaso& datos, const OpcionesReconstruccion& opciones) {
+    AmbitoTraza traza("carga", "cargarCaso");
+    AmbitoMemoria fase(FASE_CARGA);
 
-    // Mostrar informacion clara de la etapa actual
-    cout << "\n=== PROCESANDO ETAPA " << (numEtapas - etapa) << "/" << numEtapas << " ===" << endl;
-    cout << "Archivo de entrada: P" << (etapa+1) << ".bmp" << endl;
+    // Los puntos de control apuntan a las P*_reconstruida.bmp: solo en el modo por etapas
+    size_t etapasReanudables = 0;
+    if (!opciones.modoPlanificado && opciones.exportarIntermedias) {
+        datos.puntosControl = make_shared<PuntosControl>();
+        if (datos.puntosControl->abrir(datos.rutaBase, datos.numEtapas, opciones.reanudar)) {
+            etapasReanudables = datos.puntosControl->etapasGuardadas().size();
+        } else {
+            datos.puntosControl.reset();
+        }
+    }
 
-    // 1. Exportar la imagen actual como P(etapa+1).bmp
-    QString nombreImagen = rutaBase + QString("P%1.bmp").arg(etapa+1);
-    if (!exportImage(currentImg, width, height, nombreImagen)) {
-        cerr << "Error al exportar imagen P" << etapa+1 << ".bmp" << endl;
-        return false;
+    // Cargar la imagen de la ultima etapa guardada en lugar de I_D.bmp. Si falta o no
+    // coincide con su digesto (por ejemplo, la ejecucion se corto mientras se escribia)
+    // se prueba con la etapa anterior, hasta volver a I_D.bmp.
+    while (true) {
+        const EtapaCompletada* guardada = etapasReanudables > 0 ? &datos.puntosControl->etapasGuardadas()[etapasReanudables - 1] : nullptr;
+        if (!guardada) {
+            if (!cargarDatosBase(datos.rutaBase, "I_D.bmp", datos.width, datos.height, datos.mask_width, datos.mask_height, datos.imagenID, datos.imagenIM, datos.imagenM)) {
+                return false;
+            }
+            break;
+        }
+        if (QFileInfo::exists(datos.rutaBase + guardada->imagen) &&
+            cargarDatosBase(datos.rutaBase, guardada->imagen, datos.width, datos.height, datos.mask_width, datos.mask_height, datos.imagenID, datos.imagenIM, datos.imagenM) &&
+            DigestoBytes(datos.imagenID->datos(), datos.imagenID->bytes()) == guardada->digestoImagen) {
+            salida() << "Reanudando desde " << guardada->imagen.toStdString() << ": " << etapasReanudables
+                     << " de " << datos.numEtapas << " etapas ya aplicadas\n";
+            break;
+        }
+        REGISTRO_AVISO << "Aviso: " << guardada->imagen.toStdString() << " no coincide con su punto de control\n";
+        etapasReanudables--;
+    }
+    if (datos.puntosControl) {
+        datos.puntosControl->conservar(etapasReanudables);
     }
+    datos.etapasCompletadas = (int)etapasReanudables;
 
-    // 2. Determinar que operacion se aplico en esta etapa
-    int operacion = DeterminarOperacionInversa(currentImg, IM, M, maskingData[etapa], seeds[etapa], width, height, mask_width, mask_height);
-    if (operacion == -1) {
-        cerr << "No se pudo determinar la operacion para la etapa " << etapa << endl;
+    if (!cargarDatosEnmascaramiento(datos.rutaBase, datos.numEtapas, datos.mascaras, datos.etapas)) {
+        liberarCaso(datos);
         return false;
     }
 
-    // Guardar la operacion detectada para mostrar al final
-    operations[etapa] = operacion;
+    datos.ID = datos.imagenID->datos();
+    datos.IM = datos.imagenIM->datos();
+    datos.M = datos.imagenM->datos();
+    return true;
+}
 
-    // 3. Aplicar la operacion inversa para obtener la imagen anterior
-    unsigned char* nuevaImagen = nullptr;
+/**
+ * @brief Suelta los recursos de un caso cargado con `cargarCaso` (se puede llamar varias veces).
+ *
+ * Cada recurso se libera cuando lo suelta su ultimo usuario.
+ */
 
-    if (operacion == 1) { // XOR
-        nuevaImagen = aplicarOperacionInversa(currentImg, IM, operacion, width, height);
-    } else { // Rotaciones
-        nuevaImagen = aplicarOperacionInversa(currentImg, nullptr, operacion, width, height);
+void liberarCaso(DatosCaso& datos) {
+    datos.etapas.clear();
+    datos.imagenID.reset();
+    datos.imagenIM.reset();
+    datos.imagenM.reset();
+    datos.mascaras.clear();
+    datos.puntosControl.reset();
+    datos.etapasCompletadas = 0;
+
+    datos.ID = datos.IM = datos.M = nullptr;
+}
+
+/**
+ * @brief Cuenta las etapas de un caso buscando M1.txt, M2.txt, ... consecutivos.
+ *
+ * @param rutaBase Directorio del caso (terminado en '/').
+ *
+ * @return int Numero de archivos M*.txt encontrados sin saltos (0 si no hay ninguno).
+ */
+
+int detectarNumEtapas(const QString& rutaBase) {
+    int numEtapas = 0;
+    while (QFileInfo::exists(rutaBase + "M" + QString::number(numEtapas + 1) + ".txt")) {
+        numEtapas++;
     }
+    return numEtapas;
+}
 
-    if (!nuevaImagen) {
-        cerr << "Error al aplicar operacion inversa en etapa " << etapa << endl;
-        return false;
+/**
+ * @brief Reconstruye la imagen original de un caso ya cargado.
+ *
+ * - Aplica operaciones inversas en orden inverso a la distorsion.
+ * - Guarda las imagenes intermedias y la imagen final reconstruida.
+ * - Muestra un resumen de operaciones aplicadas.
+ *
+ * La deteccion y la reconstruccion las hace la biblioteca (`desafio_reconstruir`); aqui
+ * solo se exportan las imagenes y se registran los puntos de control. En modo planificado
+ * la biblioteca aplica la cadena inversa completa en una sola pasada sobre la imagen; en
+ * ese modo no se guardan las imagenes intermedias P*.bmp.
+ *
+ * Todas las imagenes se escriben en segundo plano con un `ExportadorAsincrono`; antes del
+ * resumen final se espera a que terminen y se informan los errores.
+ *
+ * @param datos Caso cargado con `cargarCaso` (no se modifica ni se libera).
+ * @param opciones Modo de reconstruccion y exportaciones a realizar.
+ *
+ * @return true Si la imagen final se reconstruyo y se guardo.
+ *
+ * @see procesarEtapa, desafio_reconstruir
+ */
+
+bool reconstruirCaso(const DatosCaso& datos, const OpcionesReconstruccion& opciones) {
+    AmbitoTraza traza("etapa", "reconstruirCaso", (long long)datos.width * datos.height * 3);
+    traza.argumento("etapas", datos.numEtapas);
+
+    const QString& rutaBase = datos.rutaBase;
+    int numEtapas = datos.numEtapas;
+    int width = datos.width, height = datos.height;
+
+    Imagen reconstruida;
+    {
+        AmbitoMemoria fase(FASE_APLICACION);
+        reconstruida = Imagen(width, height);
+    }
+    const unsigned char* currentImg = reconstruida.datos();
+    int* operations = new int[numEtapas];
+    int etapasPendientes = numEtapas - datos.etapasCompletadas;
+    for (int i = 0; i < datos.etapasCompletadas; i++) {
+        const EtapaCompletada& guardada = datos.puntosControl->etapasGuardadas()[i];
+        operations[guardada.etapa] = guardada.operacion;
+    }
+    ExportadorAsincrono exportador;
+
+    // Las etapas pendientes son las primeras: las ya completadas son las ultimas en aplicarse
+    DesafioEntrada entrada;
+    entrada.distorsionada = DesafioImagen{ datos.ID, width, height };
+    entrada.imagenXOR = DesafioImagen{ datos.IM, width, height };
+    entrada.mascara = DesafioImagen{ datos.M, datos.mask_width, datos.mask_height };
+    entrada.etapas = datos.etapas.data();
+    entrada.numEtapas = etapasPendientes;
+
+    ContextoBiblioteca contexto;
+    contexto.datos = &datos;
+    contexto.exportador = (!opciones.modoPlanificado && opciones.exportarIntermedias) ? &exportador : nullptr;
+    contexto.salidaCaso = SalidaActual();
+
+    DesafioOpciones biblioteca;
+    biblioteca.porEtapas = opciones.modoPlanificado ? 0 : 1;
+    biblioteca.etapaAplicada = procesarEtapa;
+    biblioteca.mensaje = reenviarMensaje;
+    biblioteca.contexto = &contexto;
+
+    if (!opciones.modoPlanificado) {
+        salida() << "\nINICIANDO RECONSTRUCCION (" << etapasPendientes << " de " << numEtapas << " etapas)\n\n";
+    }
+    if (contexto.exportador && etapasPendientes > 0) {
+        exportador.encolar(datos.ID, width, height, rutaBase + QString("P%1.bmp").arg(etapasPendientes));
     }
 
-    // 4. Actualizar imagen y guardar reconstruccion
-    if (currentImg != ID) {
-        delete[] currentImg;
+    int estado = desafio_reconstruir(&entrada, &biblioteca, operations, reconstruida.datos());
+    bool success = (estado == DESAFIO_OK);
+    if (!success) {
+        salidaError() << "!! RECONSTRUCCION FALLIDA: " << desafio_descripcion_error(estado) << '\n';
     }
-    currentImg = nuevaImagen;
 
-    QString nombreReconstruida = rutaBase + QString("P%1_reconstruida.bmp").arg(etapa);
-    if (!exportImage(currentImg, width, height, nombreReconstruida)) {
-        cerr << "ADVERTENCIA: No se pudo guardar reconstruccion intermedia" << endl;
+
+    // Guardar resultado final y verificarlo en memoria mientras se escribe
+
+    if (success) {
+        QString finalPath = rutaBase + "I_0Reconstruida.bmp";
+        exportador.encolar(currentImg, width, height, finalPath);
+
+        VerificacionReconstruccion verificacion;
+        bool verificada;
+        {
+            AmbitoMemoria fase(FASE_VERIFICACION);
+            verificada = VerificarReconstruccion(rutaBase, VistaLectura(currentImg, width, height), verificacion);
+        }
+        exportador.finalizar();
+
+        if (exportador.fallo(finalPath)) {
+            success = false;
+            salidaError() << "ERROR: No se pudo guardar la imagen final\n";
+        } else if (!verificada) {
+            success = false;
+            salidaError() << "!! LA IMAGEN RECONSTRUIDA NO PASO LA VERIFICACION\n";
+            mostrarVerificacion(verificacion);
+        } else {
+            salida() << "\nRECONSTRUCCION EXITOSA!\n";
+            mostrarResumenOperaciones(operations, numEtapas);
+            mostrarVerificacion(verificacion);
+        }
+    } else {
+        exportador.finalizar();
     }
 
-    cout << "=== ETAPA " << (numEtapas - etapa) << " COMPLETADA ===" << endl;
-    cout << "==========================" << endl;
+    delete[] operations;
+    return success;
+}
 
-    return true;
+/**
+ * @brief Muestra las operaciones de la reconstruccion, de la ultima aplicada a la primera.
+ */
+
+void mostrarResumenOperaciones(const int* operations, int numEtapas) {
+    salida() << "\nRESUMEN DE OPERACIONES:\n";
+    salida() << "Orden reconstruido (de ultima a primera aplicacion):\n";
+    for (int i = numEtapas - 1; i >= 0; i--) {
+        salida() << "Etapa " << (numEtapas - i) << ": ";
+        printOperationDescription(operations[i]);
+        salida() << '\n';
+    }
+
+    // Añadir una etapa XOR como ultima
+    salida() << "Etapa " << (numEtapas + 1) << ": ";
+    printOperationDescription(1);
+    salida() << '\n';
+}
+
+/**
+ * @brief Muestra el resultado de la verificacion en memoria: digestos y bytes distintos.
+ */
 
+void mostrarVerificacion(const VerificacionReconstruccion& verificacion) {
+    char digesto[32];
+    snprintf(digesto, sizeof(digesto), "%016llx", (unsigned long long)verificacion.digestoReconstruida);
+    salida() << "\nVERIFICACION EN MEMORIA: " << (verificacion.correcta() ? "CORRECTA" : "FALLIDA") << '\n';
+    salida() << "Digesto reconstruida: " << digesto << '\n';
+
+    if (verificacion.hayOriginal) {
+        snprintf(digesto, sizeof(digesto), "%016llx", (unsigned long long)verificacion.digestoOriginal);
+        salida() << "Digesto I_O:          " << digesto << '\n';
+        if (verificacion.bytesDistintos == 0) {
+            salida() << "Coincide byte a byte con I_O (" << verificacion.totalBytes << " bytes)\n";
+        } else {
+            salida() << "Difiere de I_O: primer byte distinto en " << verificacion.primeraDiferencia << ", "
+                     << verificacion.bytesDistintos << " de " << verificacion.totalBytes << " bytes distintos\n";
+        }
+    } else {
+        salida() << "Sin I_O.bmp para comparar\n";
+    }
+
+    if (verificacion.validacionM0 >= 0) {
+        salida() << "M0.txt: " << (verificacion.validacionM0 ? "cumple" : "NO cumple") << '\n';
+    }
 }
 
 /**
- * @brief Reconstruye la imagen original a partir de una version distorsionada mediante varias etapas de enmascaramiento.
+ * @brief Reconstruye un caso por bandas de filas, sin tener ninguna imagen completa en memoria.
  *
- * Esta funcion orquesta el proceso completo de reconstruccion:
- * - Carga las imagenes base y la mascara.
- * - Carga los datos de enmascaramiento para todas las etapas.
- * - Aplica operaciones inversas en orden inverso a la distorsion.
- * - Guarda las imagenes intermedias y la imagen final reconstruida.
- * - Muestra un resumen de operaciones aplicadas.
+ * Pensado para imagenes de varios gigapixeles. Las operaciones se planifican leyendo de
+ * I_D.bmp e I_M.bmp solo las filas que cubre la ventana de cada semilla; despues la cadena
+ * inversa se aplica banda por banda: se leen las filas de ID (y de IM si la cadena tiene
+ * XOR), se transforman en el mismo buffer y se escriben en I_0Reconstruida.bmp. La memoria
+ * usada depende de `opciones.filasPorBanda` y del ancho, no del alto de la imagen.
  *
- * @param rutaBase Ruta base donde se encuentran las imagenes y se guardaran los resultados.
+ * En este modo no se guardan imagenes intermedias. La verificacion se hace banda por
+ * banda: digesto de la reconstruccion y, si I_O.bmp es un BMP de 24 bits, comparacion
+ * con sus mismas filas; M0.txt no se valida porque necesita la imagen completa.
+ * I_D.bmp e I_M.bmp deben ser BMP de 24 bits sin compresion.
+ *
+ * @param rutaBase Directorio del caso (terminado en '/').
  * @param numEtapas Numero de etapas de enmascaramiento aplicadas.
+ * @param opciones Opciones de la ejecucion; se usa `filasPorBanda`.
  *
- * @see cargarDatosBase, cargarDatosEnmascaramiento, procesarEtapa, exportImage, printOperationDescription
+ * @return true Si la imagen final se reconstruyo y se guardo.
+ *
+ * @see desafio_planificar_ventanas, desafio_aplicar_operaciones, LeerBandaBMP
  */
 
-void reconstruirImagen(const QString& rutaBase, int numEtapas) {
-    // 1. Cargar datos base
-    int width, height, mask_width, mask_height;
-    unsigned char *IM, *ID, *IO, *M;
+bool reconstruirPorBandas(const QString& rutaBase, int numEtapas, const OpcionesReconstruccion& opciones) {
+    AmbitoTraza traza("etapa", "reconstruirPorBandas");
+    traza.argumento("etapas", numEtapas);
+    AmbitoMemoria faseCarga(FASE_CARGA);
 
-    if (!cargarDatosBase(rutaBase, width, height, mask_width, mask_height, ID, IM, IO, M)) {
-        return;
+    ArchivoBandasBMP archivoID, archivoIM;
+    if (!AbrirBMPPorBandas(rutaBase + "I_D.bmp", archivoID) || !AbrirBMPPorBandas(rutaBase + "I_M.bmp", archivoIM)) {
+        salidaError() << "Error: I_D.bmp e I_M.bmp deben ser BMP de 24 bits sin compresion para procesar por bandas\n";
+        return false;
+    }
+    if (archivoID.ancho != archivoIM.ancho || archivoID.alto != archivoIM.alto) {
+        salidaError() << "Error: las imagenes base no tienen las mismas dimensiones\n";
+        return false;
     }
+    int width = archivoID.ancho, height = archivoID.alto;
 
-    // 2. Cargar datos de enmascaramiento
-    unsigned int** maskingData;
-    int *seeds, *numPixels;
+    shared_ptr<const Imagen> imagenM = AlmacenRecursos::global().imagen(rutaBase + "M.bmp");
+    if (!imagenM || imagenM->ancho() == 0 || imagenM->alto() == 0) {
+        salidaError() << "Error: No se pudo cargar la mascara M o dimensiones invalidas\n";
+        return false;
+    }
+    const unsigned char* M = imagenM->datos();
+    int mask_width = imagenM->ancho(), mask_height = imagenM->alto();
 
-    if (!cargarDatosEnmascaramiento(rutaBase, numEtapas, maskingData, seeds, numPixels)) {
-        delete[] IM;
-        delete[] ID;
-        delete[] IO;
-        delete[] M;
-        return;
+    vector<shared_ptr<const MascaraCargada>> mascaras;
+    vector<DesafioEtapa> etapas;
+    if (!cargarDatosEnmascaramiento(rutaBase, numEtapas, mascaras, etapas)) {
+        return false;
     }
 
-    // 3. Preparar reconstruccion
-    unsigned char* currentImg = ID;
-    int* operations = new int[numEtapas];
+    int filasPorBanda = opciones.filasPorBanda < height ? opciones.filasPorBanda : height;
+    size_t bytesFila = (size_t)width * 3;
+    long long totalBytes = (long long)bytesFila * height;
+    int maskSize = mask_width * mask_height * 3;
+    salida() << "Imagenes base: " << width << "x" << height << " (" << totalBytes << " bytes), bandas de "
+             << filasPorBanda << " filas\n";
+
+    // 1. Leer de ID e IM solo las filas que cubre la ventana de cada etapa
+    vector<vector<unsigned char>> filasID(numEtapas), filasIM(numEtapas);
+    vector<const unsigned char*> ventanasID(numEtapas), ventanasIM(numEtapas);
+    vector<int> longitudes(numEtapas);
     bool success = true;
 
-    // 4. Procesar cada etapa en orden inverso con mejor feedback
-    cout << "\nINICIANDO RECONSTRUCCION (" << numEtapas << " etapas)\n" << endl;
+    for (int etapa = 0; etapa < numEtapas && success; etapa++) {
+        long long semilla = etapas[etapa].semilla;
+        if (semilla < 0 || semilla > totalBytes) semilla = totalBytes;
+        long long disponible = totalBytes - semilla;
+        int longitud = disponible < maskSize ? (int)disponible : maskSize;
 
-    for (int etapa = numEtapas-1; etapa >= 0; etapa--) {
-        cout << ">> Procesando etapa " << (numEtapas - etapa)
-        << " (archivo P" << (etapa+1) << ".bmp)" << endl;
+        long long filaInicio = semilla / (long long)bytesFila;
+        int numFilas = longitud > 0 ? (int)((semilla + longitud - 1) / (long long)bytesFila - filaInicio + 1) : 0;
+        filasID[etapa].resize(numFilas > 0 ? numFilas * bytesFila : 1);
+        filasIM[etapa].resize(numFilas > 0 ? numFilas * bytesFila : 1);
 
-        if (!procesarEtapa(etapa, numEtapas, currentImg, ID, IO, IM, M, maskingData, seeds, width, height, mask_width, mask_height, operations, rutaBase)) {
+        if (numFilas > 0 && (!LeerBandaBMP(archivoID, (int)filaInicio, numFilas, filasID[etapa].data()) ||
+                             !LeerBandaBMP(archivoIM, (int)filaInicio, numFilas, filasIM[etapa].data()))) {
+            salidaError() << "Error: no se pudo leer la ventana de la etapa " << etapa + 1 << '\n';
             success = false;
-            cerr << "!! RECONSTRUCCION FALLIDA EN ETAPA " << (numEtapas - etapa) << endl;
-            break;
         }
-    }
 
+        size_t desplazamiento = numFilas > 0 ? (size_t)(semilla - filaInicio * (long long)bytesFila) : 0;
+        ventanasID[etapa] = filasID[etapa].data() + desplazamiento;
+        ventanasIM[etapa] = filasIM[etapa].data() + desplazamiento;
+        longitudes[etapa] = longitud;
+    }
 
+    // 2. Planificar con las ventanas
+    int* operations = new int[numEtapas];
+    ContextoBiblioteca contexto;
+    contexto.salidaCaso = SalidaActual();
+    DesafioOpciones biblioteca = { 0, nullptr, reenviarMensaje, &contexto };
     if (success) {
-        if (!crearCopiaValidada(rutaBase)) {
-            cerr << "Advertencia: No se pudo crear la copia validada" << endl;
+        int estado = desafio_planificar_ventanas(ventanasID.data(), ventanasIM.data(), longitudes.data(), DesafioImagen{ M, mask_width, mask_height },
+                                                 etapas.data(), numEtapas, &biblioteca, operations);
+        if (estado != DESAFIO_OK) {
+            success = false;
+            salidaError() << "!! RECONSTRUCCION FALLIDA: " << desafio_descripcion_error(estado) << '\n';
         }
     }
 
-    // 5. Guardar resultado final con verificacion
+    // I_M solo se lee si alguna etapa es un XOR
+    bool usaIM = false;
+    for (int etapa = 0; success && etapa < numEtapas; etapa++) {
+        if (operations[etapa] == 1) usaIM = true;
+    }
+
+    // 3. Aplicar la cadena banda por banda sobre un mismo buffer
+    QString finalPath = rutaBase + "I_0Reconstruida.bmp";
+    VerificacionReconstruccion verificacion;
+    ArchivoBandasBMP archivoFinal;
+    if (success && !CrearBMPPorBandas(finalPath, width, height, archivoFinal)) {
+        success = false;
+        salidaError() << "ERROR: No se pudo crear " << finalPath.toStdString() << '\n';
+    }
 
     if (success) {
-        QString finalPath = rutaBase + "I_0Reconstruida.bmp";
-        if (exportImage(currentImg, width, height, finalPath)) {
-            cout << "\nRECONSTRUCCION EXITOSA!" << endl;
-
-            // Mostrar resumen ordenado inversamente
-            cout << "\nRESUMEN DE OPERACIONES:" << endl;
-            cout << "Orden reconstruido (de ultima a primera aplicacion):" << endl;
-            for (int i = numEtapas - 1; i >= 0; i--) {
-                cout << "Etapa " << (numEtapas - i) << ": ";
-                printOperationDescription(operations[i]);
-                cout << endl;
+        AmbitoMemoria fase(FASE_APLICACION);
+        salida() << "\nAplicando las operaciones inversas de " << numEtapas << " etapas por bandas\n";
+
+        // La original se compara con las mismas filas de cada banda, si se puede leer por bandas
+        ArchivoBandasBMP archivoIO;
+        QString rutaOriginal = rutaBase + "I_O.bmp";
+        bool hayOriginal = QFileInfo::exists(rutaOriginal) && AbrirBMPPorBandas(rutaOriginal, archivoIO)
+                           && archivoIO.ancho == width && archivoIO.alto == height;
+        CalculoDigesto digestoReconstruida, digestoOriginal;
+        verificacion.totalBytes = totalBytes;
+        verificacion.hayOriginal = hayOriginal;
+
+        Imagen banda(width, filasPorBanda);
+        Imagen bandaIM = usaIM ? Imagen(width, filasPorBanda) : Imagen();
+        Imagen bandaIO = hayOriginal ? Imagen(width, filasPorBanda) : Imagen();
+        for (int fila = 0; fila < height && success; fila += filasPorBanda) {
+            int numFilas = height - fila < filasPorBanda ? height - fila : filasPorBanda;
+            AmbitoTraza trazaBanda("etapa", "banda", (long long)numFilas * bytesFila);
+            trazaBanda.argumento("fila", fila);
+
+            if (!LeerBandaBMP(archivoID, fila, numFilas, banda.datos()) ||
+                (usaIM && !LeerBandaBMP(archivoIM, fila, numFilas, bandaIM.datos()))) {
+                salidaError() << "Error: no se pudo leer la banda de la fila " << fila << '\n';
+                success = false;
+                break;
+            }
+            if (desafio_aplicar_operaciones(operations, numEtapas, banda.datos(), bandaIM.datos(), banda.datos(), (size_t)numFilas * bytesFila) != DESAFIO_OK) {
+                salidaError() << "Error: no se pudieron aplicar las operaciones a la banda de la fila " << fila << '\n';
+                success = false;
+                break;
+            }
+            if (!EscribirBandaBMP(archivoFinal, fila, numFilas, banda.datos())) {
+                salidaError() << "ERROR: No se pudo guardar la imagen final\n";
+                success = false;
             }
 
-            // Añadir una etapa XOR como ultima
-            cout << "Etapa " << (numEtapas + 1) << ": ";
-            printOperationDescription(1);
-            cout << endl;
-
-        } else {
-            cerr << "ERROR: No se pudo guardar la imagen final" << endl;
+            size_t bytesBanda = (size_t)numFilas * bytesFila;
+            digestoReconstruida.agregar(banda.datos(), bytesBanda);
+            if (hayOriginal) {
+                if (LeerBandaBMP(archivoIO, fila, numFilas, bandaIO.datos())) {
+                    digestoOriginal.agregar(bandaIO.datos(), bytesBanda);
+                    CompararBytes(banda.datos(), bandaIO.datos(), bytesBanda, (long long)fila * bytesFila, verificacion);
+                } else {
+                    salidaError() << "Error: no se pudo leer I_O.bmp para verificar la banda de la fila " << fila << '\n';
+                    verificacion.hayOriginal = hayOriginal = false;
+                }
+            }
         }
+        archivoFinal.archivo.close();
+        verificacion.digestoReconstruida = digestoReconstruida.valor();
+        verificacion.digestoOriginal = digestoOriginal.valor();
     }
 
-    // 6. Liberar memoria
-    delete[] IM;
-    delete[] ID;
-    delete[] IO;
-    delete[] M;
-    for (int i = 0; i < numEtapas; i++) {
-        delete[] maskingData[i];
+    if (success && !verificacion.correcta()) {
+        success = false;
+        salidaError() << "!! LA IMAGEN RECONSTRUIDA NO PASO LA VERIFICACION\n";
+        mostrarVerificacion(verificacion);
+    } else if (success) {
+        salida() << "\nRECONSTRUCCION EXITOSA!\n";
+        mostrarResumenOperaciones(operations, numEtapas);
+        mostrarVerificacion(verificacion);
     }
-    delete[] maskingData;
-    delete[] seeds;
-    delete[] numPixels;
+
     delete[] operations;
+    return success;
+}
+
+/**
+ * @brief Reconstruye la imagen original de un unico caso: lo carga, lo reconstruye y libera la memoria.
+ *
+ * @param rutaBase Ruta base donde se encuentran las imagenes y se guardaran los resultados.
+ * @param numEtapas Numero de etapas de enmascaramiento aplicadas.
+ * @param opciones Modo de reconstruccion y exportaciones a realizar.
+ *
+ * @return true Si el caso se reconstruyo correctamente.
+ *
+ * @see cargarCaso, reconstruirCaso, liberarCaso
+ */
+
+bool reconstruirImagen(const QString& rutaBase, int numEtapas, const OpcionesReconstruccion& opciones) {
+    if (opciones.filasPorBanda > 0) {
+        return reconstruirPorBandas(rutaBase, numEtapas, opciones);
+    }
+
+    DatosCaso datos;
+    datos.rutaBase = rutaBase;
+    datos.numEtapas = numEtapas;
+
+    if (!cargarCaso(datos, opciones)) {
+        return false;
+    }
+    bool exito = reconstruirCaso(datos, opciones);
+    liberarCaso(datos);
+    return exito;
 }
 
-int main() {
+// Estado de un caso dentro de un lote
+struct CasoLote {
+    DatosCaso datos;
+    SalidaCaso salida;   // mensajes del caso, se imprimen juntos al terminar
+    bool exito = false;
+};
 
-    // Configuracion de parametros
+/**
+ * @brief Reconstruye varios casos a la vez en el pool global de hilos.
+ *
+ * Cada caso se divide en dos tareas: la carga y la reconstruccion. Al empezar se
+ * encolan las cargas de tantos casos como hilos (mas uno, para tener siempre el
+ * siguiente caso cargandose); cuando una carga termina encola la reconstruccion de
+ * su caso, y cuando una reconstruccion termina libera la memoria y encola la carga
+ * del siguiente caso pendiente. Asi nunca hay en memoria mas casos de los que se
+ * pueden procesar a la vez.
+ *
+ * Los mensajes de cada caso se acumulan en su propia `SalidaCaso` y se imprimen
+ * completos al terminarlo, por lo que no se mezclan entre casos.
+ *
+ * Con `opciones.filasPorBanda` cada caso es una sola tarea que lee sus imagenes por
+ * bandas (`reconstruirPorBandas`), sin carga previa.
+ *
+ * @param rutas Directorios de los casos (terminados en '/').
+ * @param etapasForzadas Numero de etapas para todos los casos, o 0 para detectarlo en cada uno.
+ * @param opciones Modo de reconstruccion y exportaciones a realizar.
+ *
+ * @return int Numero de casos que fallaron.
+ *
+ * @see cargarCaso, reconstruirCaso, detectarNumEtapas
+ */
+
+int procesarLote(const QStringList& rutas, int etapasForzadas, const OpcionesReconstruccion& opciones) {
+    PoolHilos& pool = PoolHilos::global();
+    int total = rutas.size();
+
+    vector<unique_ptr<CasoLote>> casos;
+    for (const QString& ruta : rutas) {
+        casos.emplace_back(new CasoLote);
+        casos.back()->datos.rutaBase = ruta;
+    }
+
+    GrupoTareas lote;
+    atomic<int> siguiente{0};
+    function<void()> lanzarSiguiente;
+
+    // Imprime los mensajes del caso y deja lugar para el siguiente
+    auto terminarCaso = [&](CasoLote* caso) {
+        if (!caso->exito) {
+            salidaError() << "CASO FALLIDO: " << caso->datos.rutaBase.toStdString() << '\n';
+        }
+        ImprimirSalidaCaso(caso->salida);
+        lanzarSiguiente();
+    };
+
+    // Encola la carga del siguiente caso pendiente; al cargar, encola su reconstruccion
+    lanzarSiguiente = [&] {
+        int indice = siguiente.fetch_add(1);
+        if (indice >= total) return;
+        CasoLote* caso = casos[indice].get();
+
+        // Las tareas heredan el destino de mensajes activo al encolarlas
+        AmbitoSalida ambito(&caso->salida);
+        pool.encolar(lote, [&, caso, indice] {
+            DatosCaso& datos = caso->datos;
+            salida() << "=============================================\n";
+            salida() << "Caso " << (indice + 1) << "/" << total << ": " << datos.rutaBase.toStdString() << '\n';
+
+            datos.numEtapas = etapasForzadas > 0 ? etapasForzadas : detectarNumEtapas(datos.rutaBase);
+            if (datos.numEtapas == 0) {
+                salidaError() << "Error: no se encontro ningun archivo M1.txt en el caso\n";
+            }
+            if (datos.numEtapas > 0 && opciones.filasPorBanda > 0) {
+                salida() << "Numero de etapas: " << datos.numEtapas + 1 << '\n';
+                caso->exito = reconstruirPorBandas(datos.rutaBase, datos.numEtapas, opciones);
+                terminarCaso(caso);
+                return;
+            }
+            if (datos.numEtapas == 0 || !cargarCaso(datos, opciones)) {
+                terminarCaso(caso);
+                return;
+            }
+            salida() << "Numero de etapas: " << datos.numEtapas + 1 << '\n';
+
+            // Se encola desde este trabajador: va a su cola propia y es lo siguiente que ejecuta
+            pool.encolar(lote, [&, caso] {
+                caso->exito = reconstruirCaso(caso->datos, opciones);
+                liberarCaso(caso->datos);
+                terminarCaso(caso);
+            });
+        });
+    };
+
+    int enVuelo = pool.numHilos() + 1;
+    for (int i = 0; i < enVuelo && i < total; i++) {
+        lanzarSiguiente();
+    }
+    pool.esperar(lote);
+
+    int fallidos = 0;
+    for (const unique_ptr<CasoLote>& caso : casos) {
+        if (!caso->exito) fallidos++;
+    }
+    return fallidos;
+}
+
+/**
+ * @brief Ejecuta un trabajo recibido en modo servidor: un caso con sus propias opciones.
+ *
+ * Los mensajes van a la salida del trabajo (ver `EjecutarServidor`), que los envia al
+ * cliente a medida que se escriben.
+ */
+
+bool ejecutarTrabajoServidor(const TrabajoServidor& trabajo) {
+    OpcionesReconstruccion opciones;
+    opciones.modoPlanificado = trabajo.modoPlanificado;
+    opciones.exportarIntermedias = trabajo.exportarIntermedias;
+    opciones.reanudar = trabajo.reanudar;
+    opciones.filasPorBanda = trabajo.filasPorBanda;
+
+    int numEtapas = trabajo.numEtapas > 0 ? trabajo.numEtapas : detectarNumEtapas(trabajo.rutaBase);
+    if (numEtapas == 0) {
+        salidaError() << "Error: no se encontro ningun archivo M1.txt en el caso\n";
+        return false;
+    }
+    salida() << "Numero de etapas: " << numEtapas + 1 << '\n';
+    return reconstruirImagen(trabajo.rutaBase, numEtapas, opciones);
+}
+
+/**
+ * @brief Lee el valor entero de una opcion de la linea de comandos.
+ *
+ * @return false Si `valor` no es un entero o es menor que `minimo` (se informa en cerr).
+ */
+
+bool leerEnteroOpcion(const string& opcion, const QString& valor, int minimo, int& resultado) {
+    bool valido = false;
+    int leido = valor.toInt(&valido);
+    if (!valido || leido < minimo) {
+        cerr << "Valor no valido para " << opcion << ": " << valor.toStdString()
+             << " (se espera un entero mayor o igual que " << minimo << ")\n";
+        return false;
+    }
+    resultado = leido;
+    return true;
+}
+
+/**
+ * @brief Agrega a `rutas` cada subdirectorio de `raiz` que contenga un I_D.bmp, en orden alfabetico.
+ */
+
+void buscarCasos(const QString& raiz, QStringList& rutas) {
+    QDir dir(raiz);
+    QStringList subdirectorios = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString& nombre : subdirectorios) {
+        QString ruta = dir.filePath(nombre) + "/";
+        if (QFileInfo::exists(ruta + "I_D.bmp")) {
+            rutas.append(ruta);
+        }
+    }
+}
+
+void mostrarUso(const char* programa) {
+    cout << "Uso: " << programa << " [opciones] [CASO ...]\n";
+    cout << "  CASO                 Directorio de un caso (con I_D.bmp, I_M.bmp, M.bmp, M*.txt)\n";
+    cout << "  --raiz DIR           Procesar cada subdirectorio de DIR que tenga un I_D.bmp\n";
+    cout << "  --etapas N           Numero de etapas de todos los casos (por defecto se cuentan los M*.txt)\n";
+    cout << "  --planificado        Detectar sobre ventanas y aplicar la cadena en una pasada\n";
+    cout << "  --sin-intermedias    No guardar P*.bmp ni P*_reconstruida.bmp\n";
+    cout << "  --sin-reanudar       Ignorar reanudacion.txt y aplicar todas las etapas desde I_D.bmp\n";
+    cout << "                       (por defecto, en el modo por etapas con intermedias, se continua\n";
+    cout << "                       desde la ultima etapa cuyos archivos no cambiaron)\n";
+    cout << "  --bandas FILAS       Procesar por bandas de FILAS filas sin cargar las imagenes completas\n";
+    cout << "                       (imagenes muy grandes; no guarda intermedias ni la copia validada)\n";
+    cout << "  --nivel NIVEL        Mensajes a mostrar: error, aviso, info (por defecto) o depuracion\n";
+    cout << "  --traza ARCHIVO      Guardar una traza de tiempos en formato Chrome trace (tambien DESAFIO_TRAZA)\n";
+    cout << "  --memoria ARCHIVO    Contar las asignaciones por fase y etapa, mostrarlas en el resumen final y\n";
+    cout << "                       guardarlas como JSON junto al pico de memoria residente (tambien DESAFIO_MEMORIA)\n";
+    cout << "  --servidor SOCKET    Quedar residente y recibir trabajos por el socket Unix SOCKET (JSON por\n";
+    cout << "                       lineas, ver servidor.h); no se procesan los casos de la linea de comandos\n";
+    cout << "  --cache MIB          Imagenes y mascaras decodificadas a retener entre trabajos (por defecto 1024)\n";
+    cout << "Sin casos se procesa la ruta configurada en main().\n";
+}
+
+int main(int argc, char* argv[]) {
+
+    // Configuracion de parametros (caso por defecto si no se pasan directorios)
     QString rutaBase = "C:/Users/esteb/OneDrive/Escritorio/DES/codigo/Desafio1/Caso 2/";
-    int numEtapas = 6; // Cambiar segun el numero de etapas que tenga tu caso
+    int numEtapas = 0; // 0: contar los archivos M*.txt de cada caso
+    OpcionesReconstruccion opciones;
+    opciones.modoPlanificado = false;    // true: detectar sobre ventanas y aplicar la cadena en una pasada
+    opciones.exportarIntermedias = true; // false: no guardar P*.bmp ni P*_reconstruida.bmp
+    opciones.filasPorBanda = 0;          // > 0: procesar por bandas (imagenes de varios gigapixeles)
+    opciones.reanudar = true;            // false: ignorar los puntos de control de ejecuciones anteriores
+
+    QString rutaTraza = QString::fromLocal8Bit(getenv("DESAFIO_TRAZA") ? getenv("DESAFIO_TRAZA") : "");
+    QString rutaMemoria = QString::fromLocal8Bit(getenv("DESAFIO_MEMORIA") ? getenv("DESAFIO_MEMORIA") : "");
+    QString rutaSocket;                  // no vacia: modo servidor en ese socket Unix
+    size_t capacidadCache = CAPACIDAD_CACHE_SERVIDOR;
+
+    QStringList rutas;
+    bool casosIndicados = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--planificado") {
+            opciones.modoPlanificado = true;
+        } else if (arg == "--sin-intermedias") {
+            opciones.exportarIntermedias = false;
+        } else if (arg == "--sin-reanudar") {
+            opciones.reanudar = false;
+        } else if (arg == "--nivel" && i + 1 < argc) {
+            NivelRegistro nivel;
+            if (!NivelRegistroDesdeTexto(argv[++i], nivel)) {
+                cerr << "Nivel de registro desconocido: " << argv[i] << '\n';
+                mostrarUso(argv[0]);
+                return 1;
+            }
+            EstablecerNivelRegistro(nivel);
+        } else if ((arg == "--etapas" || arg == "--raiz" || arg == "--traza" || arg == "--memoria" || arg == "--bandas" || arg == "--servidor" || arg == "--cache") && i + 1 < argc) {
+            QString valor = QString::fromLocal8Bit(argv[++i]);
+            if (arg == "--servidor") {
+                rutaSocket = valor;
+            } else if (arg == "--cache") {
+                int megas = 0;
+                if (!leerEnteroOpcion(arg, valor, 0, megas)) {
+                    mostrarUso(argv[0]);
+                    return 1;
+                }
+                capacidadCache = (size_t)megas * 1024 * 1024;
+            } else if (arg == "--etapas") {
+                // 0: contar los M*.txt de cada caso
+                if (!leerEnteroOpcion(arg, valor, 0, numEtapas)) {
+                    mostrarUso(argv[0]);
+                    return 1;
+                }
+            } else if (arg == "--bandas") {
+                if (!leerEnteroOpcion(arg, valor, 1, opciones.filasPorBanda)) {
+                    mostrarUso(argv[0]);
+                    return 1;
+                }
+            } else if (arg == "--traza") {
+                rutaTraza = valor;
+            } else if (arg == "--memoria") {
+                rutaMemoria = valor;
+            } else {
+                buscarCasos(valor, rutas);
+                casosIndicados = true;
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            mostrarUso(argv[0]);
+            return 0;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            cerr << "Opcion desconocida o incompleta: " << arg << '\n';
+            mostrarUso(argv[0]);
+            return 1;
+        } else {
+            QString ruta = QDir::fromNativeSeparators(QString::fromLocal8Bit(argv[i]));
+            if (!ruta.endsWith('/')) ruta += '/';
+            rutas.append(ruta);
+            casosIndicados = true;
+        }
+    }
+    if (!casosIndicados) {
+        rutas.append(rutaBase);
+    }
+    if (!rutaTraza.isEmpty()) {
+        IniciarTraza(rutaTraza);
+    }
+    if (!rutaMemoria.isEmpty()) {
+        IniciarMemoria(rutaMemoria);
+    }
+
+    if (!rutaSocket.isEmpty()) {
+        int codigo = EjecutarServidor(rutaSocket, capacidadCache, ejecutarTrabajoServidor);
+        if (!rutaTraza.isEmpty() && !FinalizarTraza()) {
+            cerr << "No se pudo guardar la traza en " << rutaTraza.toStdString() << '\n';
+        }
+        if (!rutaMemoria.isEmpty() && !FinalizarMemoria()) {
+            cerr << "No se pudo guardar el perfil de memoria en " << rutaMemoria.toStdString() << '\n';
+        }
+        return codigo;
+    }
 
     // Mensaje inicial
 
-    cout << "=============================================" << endl;
-    cout << "  SISTEMA DE RECONSTRUCCION DE IMAGENES" << endl;
-    cout << "=============================================" << endl;
-    cout << "Ruta base: " << rutaBase.toStdString() << endl;
-    cout << "Numero de etapas: " << numEtapas + 1 << endl;
+    cout << "=============================================\n";
+    cout << "  SISTEMA DE RECONSTRUCCION DE IMAGENES\n";
+    cout << "=============================================\n";
+    cout << "Casos a procesar: " << rutas.size() << '\n';
+    cout << "Hilos: " << PoolHilos::global().numHilos() << '\n';
     cout << "Iniciando proceso..." << endl;
 
+    if (rutas.isEmpty()) {
+        cerr << "No se encontro ningun caso para procesar\n";
+        return 1;
+    }
+
     // Llamar a la funcion principal
-    reconstruirImagen(rutaBase, numEtapas);
+    int fallidos = procesarLote(rutas, numEtapas, opciones);
+
+    if (!rutaTraza.isEmpty()) {
+        if (FinalizarTraza()) {
+            cout << "Traza guardada en " << rutaTraza.toStdString() << '\n';
+        } else {
+            cerr << "No se pudo guardar la traza en " << rutaTraza.toStdString() << '\n';
+        }
+    }
+
+    if (!rutaMemoria.isEmpty()) {
+        bool guardado = FinalizarMemoria();
+        MostrarResumenMemoria();
+        if (guardado) {
+            cout << "Perfil de memoria guardado en " << rutaMemoria.toStdString() << '\n';
+        } else {
+            cerr << "No se pudo guardar el perfil de memoria en " << rutaMemoria.toStdString() << '\n';
+        }
+    }
 
-    cout << "Proceso completado" << endl;
-    return 0;
+    cout << "=============================================\n";
+    cout << "Archivos decodificados: " << AlmacenRecursos::global().decodificaciones()
+         << " (reutilizados " << AlmacenRecursos::global().reutilizaciones() << " veces)\n";
+    cout << "Proceso completado: " << (rutas.size() - fallidos) << " casos correctos, "
+         << fallidos << " fallidos\n";
+    return fallidos == 0 ? 0 : 1;
 }
@@ -0,0 +1,192 @@
+#include "memoria.h"
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <QSaveFile>
+
+#include "registro.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+atomic<bool> memoriaActiva(false);
+
+// Contadores de una fase y etapa; los actualizan los operadores desde cualquier hilo
+struct ContadoresMemoria {
+    atomic<long long> asignaciones;
+    atomic<long long> bytes;
+    atomic<long long> vivos;
+    atomic<long long> pico;
+};
+
+// Por fase: primero la ranura sin etapa y luego una por etapa
+const int RANURAS_POR_FASE = MAX_ETAPAS_MEMORIA + 1;
+
+static ContadoresMemoria contadores[NUM_FASES_MEMORIA * RANURAS_POR_FASE];
+static ContadoresMemoria total;
+static thread_local FaseActualMemoria faseDelHilo = { FASE_OTRA, -1 };
+static mutex cerrojoMemoria;
+static QString rutaMemoria;
+
+static const char* const NOMBRES_FASES[NUM_FASES_MEMORIA] = {
+    "otra", "carga", "deteccion", "aplicacion", "exportacion", "verificacion"
+};
+
+FaseActualMemoria FaseMemoriaActual() {
+    return faseDelHilo;
+}
+
+void EstablecerFaseMemoria(FaseActualMemoria fase) {
+    faseDelHilo = fase;
+}
+
+/**
+ * @brief Ranura de contadores de la fase actual del hilo, o -1 si el perfil esta apagado.
+ */
+int RanuraMemoriaActual() {
+    if (!MemoriaActiva()) return -1;
+    int etapa = faseDelHilo.etapa >= 0 && faseDelHilo.etapa < MAX_ETAPAS_MEMORIA ? faseDelHilo.etapa + 1 : 0;
+    return faseDelHilo.fase * RANURAS_POR_FASE + etapa;
+}
+
+static void actualizarPico(atomic<long long>& pico, long long valor) {
+    long long actual = pico.load(memory_order_relaxed);
+    while (valor > actual && !pico.compare_exchange_weak(actual, valor, memory_order_relaxed)) {
+    }
+}
+
+void RegistrarAsignacion(int ranura, size_t bytes) {
+    if (ranura < 0) return;
+    ContadoresMemoria* afectados[2] = { &contadores[ranura], &total };
+    for (ContadoresMemoria* c : afectados) {
+        c->asignaciones.fetch_add(1, memory_order_relaxed);
+        c->bytes.fetch_add((long long)bytes, memory_order_relaxed);
+        actualizarPico(c->pico, c->vivos.fetch_add((long long)bytes, memory_order_relaxed) + (long long)bytes);
+    }
+}
+
+void RegistrarLiberacion(int ranura, size_t bytes) {
+    if (ranura < 0) return;
+    contadores[ranura].vivos.fetch_sub((long long)bytes, memory_order_relaxed);
+    total.vivos.fetch_sub((long long)bytes, memory_order_relaxed);
+}
+
+/**
+ * @brief Pico de memoria residente del proceso en bytes (-1 si no se puede consultar).
+ */
+long long PicoMemoriaResidente() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS info;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) return -1;
+    return (long long)info.PeakWorkingSetSize;
+#else
+    struct rusage uso;
+    if (getrusage(RUSAGE_SELF, &uso) != 0) return -1;
+#ifdef __APPLE__
+    return (long long)uso.ru_maxrss;         // en bytes
+#else
+    return (long long)uso.ru_maxrss * 1024;  // en KiB
+#endif
+#endif
+}
+
+/**
+ * @brief Activa el perfil; el informe se escribira en `ruta` al llamar a `FinalizarMemoria`.
+ *
+ * Solo se cuentan los bloques reservados desde ahora.
+ */
+bool IniciarMemoria(const QString& ruta) {
+    if (ruta.isEmpty()) return false;
+    {
+        lock_guard<mutex> lock(cerrojoMemoria);
+        rutaMemoria = ruta;
+    }
+    memoriaActiva.store(true);
+    return true;
+}
+
+/**
+ * @brief Desactiva el perfil y escribe el informe como JSON.
+ *
+ * Incluye los totales, el pico de memoria residente y una entrada por cada fase (y
+ * etapa) con asignaciones. Las etapas se numeran como los archivos M*.txt.
+ *
+ * @return true Si el perfil estaba activo y se escribio el archivo.
+ */
+bool FinalizarMemoria() {
+    if (!memoriaActiva.exchange(false)) return false;
+
+    lock_guard<mutex> lock(cerrojoMemoria);
+    char linea[256];
+    snprintf(linea, sizeof(linea), "{\"asignaciones\":%lld,\"bytesAsignados\":%lld,\"picoBytesVivos\":%lld,\"picoMemoriaResidente\":%lld,\"fases\":[",
+             total.asignaciones.load(), total.bytes.load(), total.pico.load(), PicoMemoriaResidente());
+    string json = linea;
+
+    bool primero = true;
+    for (int ranura = 0; ranura < NUM_FASES_MEMORIA * RANURAS_POR_FASE; ranura++) {
+        const ContadoresMemoria& c = contadores[ranura];
+        if (c.asignaciones.load() == 0) continue;
+
+        int etapa = ranura % RANURAS_POR_FASE;
+        string textoEtapa = etapa > 0 ? to_string(etapa) : "null";
+        snprintf(linea, sizeof(linea), "%s\n{\"fase\":\"%s\",\"etapa\":%s,\"asignaciones\":%lld,\"bytesAsignados\":%lld,\"picoBytesVivos\":%lld}",
+                 primero ? "" : ",", NOMBRES_FASES[ranura / RANURAS_POR_FASE], textoEtapa.c_str(),
+                 c.asignaciones.load(), c.bytes.load(), c.pico.load());
+        json += linea;
+        primero = false;
+    }
+    json += "\n]}\n";
+
+    QSaveFile archivo(rutaMemoria);
+    if (!archivo.open(QIODevice::WriteOnly)) return false;
+    archivo.write(json.data(), (qint64)json.size());
+    return archivo.commit();
+}
+
+static string textoBytes(long long bytes) {
+    char texto[32];
+    if (bytes >= 1024 * 1024) {
+        snprintf(texto, sizeof(texto), "%.1f MiB", bytes / (1024.0 * 1024.0));
+    } else if (bytes >= 1024) {
+        snprintf(texto, sizeof(texto), "%.1f KiB", bytes / 1024.0);
+    } else {
+        snprintf(texto, sizeof(texto), "%lld B", bytes);
+    }
+    return texto;
+}
+
+/**
+ * @brief Muestra una tabla con los contadores de cada fase y etapa, y el pico residente.
+ */
+void MostrarResumenMemoria() {
+    char linea[160];
+    salida() << "\nPERFIL DE MEMORIA (new/delete):\n";
+    snprintf(linea, sizeof(linea), "%-24s %14s %16s %14s\n", "Fase", "Asignaciones", "Bytes asignados", "Pico vivos");
+    salida() << linea;
+
+    for (int ranura = 0; ranura < NUM_FASES_MEMORIA * RANURAS_POR_FASE; ranura++) {
+        const ContadoresMemoria& c = contadores[ranura];
+        if (c.asignaciones.load() == 0) continue;
+
+        string nombre = NOMBRES_FASES[ranura / RANURAS_POR_FASE];
+        int etapa = ranura % RANURAS_POR_FASE;
+        if (etapa > 0) nombre += " etapa " + to_string(etapa);
+        snprintf(linea, sizeof(linea), "%-24s %14lld %16s %14s\n", nombre.c_str(), c.asignaciones.load(),
+                 textoBytes(c.bytes.load()).c_str(), textoBytes(c.pico.load()).c_str());
+        salida() << linea;
+    }
+    snprintf(linea, sizeof(linea), "%-24s %14lld %16s %14s\n", "total", total.asignaciones.load(),
+             textoBytes(total.bytes.load()).c_str(), textoBytes(total.pico.load()).c_str());
+    salida() << linea;
+
+    long long picoResidente = PicoMemoriaResidente();
+    if (picoResidente >= 0) {
+        salida() << "Pico de memoria residente del proceso: " << textoBytes(picoResidente) << '\n';
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <atomic>
+#include <cstddef>
+#include <QString>
+
+/**
+ * Perfil de memoria: cuenta las asignaciones con new/delete (cantidad, bytes asignados
+ * y pico de bytes vivos) por fase de la ejecucion y por etapa, y al final informa el
+ * pico de memoria residente del proceso.
+ *
+ * Se activa en tiempo de ejecucion con `IniciarMemoria`, igual que la traza. Los
+ * operadores que cuentan estan en memoria_operadores.cpp y solo los enlaza la
+ * aplicacion; sin ellos (biblioteca, generador) las fases no cuestan mas que una
+ * variable por hilo. Las asignaciones de malloc (por ejemplo, las de Qt) no se cuentan.
+ */
+
+enum FaseMemoria {
+    FASE_OTRA = 0,        // fuera de cualquier fase marcada
+    FASE_CARGA,           // lectura y decodificacion de imagenes, mascaras y puntos de control
+    FASE_DETECCION,       // planificacion y verificacion de la operacion de cada etapa
+    FASE_APLICACION,      // operaciones inversas sobre la imagen
+    FASE_EXPORTACION,     // copias y escritura de imagenes en segundo plano
+    FASE_VERIFICACION,    // comparacion con I_O y M0.txt
+    NUM_FASES_MEMORIA
+};
+
+// Etapas con contadores propios; las demas se suman a su fase sin etapa
+const int MAX_ETAPAS_MEMORIA = 64;
+
+extern std::atomic<bool> memoriaActiva;
+
+inline bool MemoriaActiva() {
+    return memoriaActiva.load(std::memory_order_relaxed);
+}
+
+// Fase a la que se atribuyen las asignaciones de un hilo (etapa -1: sin etapa)
+struct FaseActualMemoria {
+    FaseMemoria fase;
+    int etapa;
+};
+
+FaseActualMemoria FaseMemoriaActual();
+void EstablecerFaseMemoria(FaseActualMemoria fase);
+
+/**
+ * Atribuye a `fase` (y a la etapa `etapa`, si no es -1) las asignaciones del hilo
+ * mientras exista el objeto. Las tareas del pool heredan la fase de quien las encolo.
+ */
+class AmbitoMemoria {
+public:
+    explicit AmbitoMemoria(FaseMemoria fase, int etapa = -1) : anterior(FaseMemoriaActual()) {
+        EstablecerFaseMemoria(FaseActualMemoria{ fase, etapa });
+    }
+    explicit AmbitoMemoria(FaseActualMemoria fase) : anterior(FaseMemoriaActual()) { EstablecerFaseMemoria(fase); }
+    ~AmbitoMemoria() { EstablecerFaseMemoria(anterior); }
+
+    AmbitoMemoria(const AmbitoMemoria&) = delete;
+    AmbitoMemoria& operator=(const AmbitoMemoria&) = delete;
+
+private:
+    FaseActualMemoria anterior;
+};
+
+bool IniciarMemoria(const QString& ruta);
+bool FinalizarMemoria();
+void MostrarResumenMemoria();
+long long PicoMemoriaResidente();
+
+// Para los operadores de memoria_operadores.cpp: no reservan memoria
+int RanuraMemoriaActual();
+void RegistrarAsignacion(int ranura, size_t bytes);
+void RegistrarLiberacion(int ranura, size_t bytes);
+
+#endif // MEMORIA_H
@@ -0,0 +1,113 @@
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "memoria.h"
+
+using namespace std;
+
+/*
+ * Operadores globales new/delete que alimentan el perfil de memoria (ver memoria.h).
+ *
+ * Cada bloque lleva delante una cabecera con su tamano y la ranura de contadores a la
+ * que se atribuyo, asi la liberacion descuenta de la misma fase aunque ocurra en otro
+ * hilo o en otra fase. La cabecera se agrega aunque el perfil este apagado: un bloque
+ * reservado antes de activarlo puede liberarse despues.
+ */
+
+struct CabeceraBloque {
+    size_t bytes;
+    int ranura;                      // -1: reservado con el perfil apagado
+    unsigned short desplazamiento;   // bytes desde el inicio de la reserva hasta el bloque
+    unsigned short alineada;         // reservado con la funcion alineada del sistema
+};
+
+const size_t ALINEACION_BASE = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+const size_t TAMANO_CABECERA = (sizeof(CabeceraBloque) + ALINEACION_BASE - 1) / ALINEACION_BASE * ALINEACION_BASE;
+
+static CabeceraBloque* cabecera(void* bloque) {
+    return (CabeceraBloque*)((unsigned char*)bloque - sizeof(CabeceraBloque));
+}
+
+static void* reservar(size_t bytes, size_t alineacion) {
+    bool alineada = alineacion > ALINEACION_BASE;
+    size_t desplazamiento = alineada && alineacion > TAMANO_CABECERA ? alineacion : TAMANO_CABECERA;
+    if (desplazamiento > UINT16_MAX || bytes > SIZE_MAX - desplazamiento) return nullptr;
+
+    void* base = nullptr;
+    if (!alineada) {
+        base = malloc(desplazamiento + bytes);
+    } else {
+#ifdef _WIN32
+        base = _aligned_malloc(desplazamiento + bytes, alineacion);
+#else
+        if (posix_memalign(&base, alineacion, desplazamiento + bytes) != 0) base = nullptr;
+#endif
+    }
+    if (!base) return nullptr;
+
+    void* bloque = (unsigned char*)base + desplazamiento;
+    CabeceraBloque* info = cabecera(bloque);
+    info->bytes = bytes;
+    info->ranura = RanuraMemoriaActual();
+    info->desplazamiento = (unsigned short)desplazamiento;
+    info->alineada = alineada;
+    RegistrarAsignacion(info->ranura, bytes);
+    return bloque;
+}
+
+// Semantica de operator new: reintenta con el new_handler y lanza bad_alloc si no hay
+static void* reservarOLanzar(size_t bytes, size_t alineacion) {
+    while (true) {
+        void* bloque = reservar(bytes, alineacion);
+        if (bloque) return bloque;
+        new_handler manejador = get_new_handler();
+        if (!manejador) throw bad_alloc();
+        manejador();
+    }
+}
+
+static void* reservarSinLanzar(size_t bytes, size_t alineacion) noexcept {
+    try {
+        return reservarOLanzar(bytes, alineacion);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+static void liberar(void* bloque) noexcept {
+    if (!bloque) return;
+    CabeceraBloque* info = cabecera(bloque);
+    RegistrarLiberacion(info->ranura, info->bytes);
+
+    void* base = (unsigned char*)bloque - info->desplazamiento;
+#ifdef _WIN32
+    if (info->alineada) {
+        _aligned_free(base);
+        return;
+    }
+#endif
+    free(base);
+}
+
+void* operator new(size_t bytes) { return reservarOLanzar(bytes, ALINEACION_BASE); }
+void* operator new[](size_t bytes) { return reservarOLanzar(bytes, ALINEACION_BASE); }
+void* operator new(size_t bytes, const nothrow_t&) noexcept { return reservarSinLanzar(bytes, ALINEACION_BASE); }
+void* operator new[](size_t bytes, const nothrow_t&) noexcept { return reservarSinLanzar(bytes, ALINEACION_BASE); }
+void* operator new(size_t bytes, align_val_t alineacion) { return reservarOLanzar(bytes, (size_t)alineacion); }
+void* operator new[](size_t bytes, align_val_t alineacion) { return reservarOLanzar(bytes, (size_t)alineacion); }
+void* operator new(size_t bytes, align_val_t alineacion, const nothrow_t&) noexcept { return reservarSinLanzar(bytes, (size_t)alineacion); }
+void* operator new[](size_t bytes, align_val_t alineacion, const nothrow_t&) noexcept { return reservarSinLanzar(bytes, (size_t)alineacion); }
+
+void operator delete(void* bloque) noexcept { liberar(bloque); }
+void operator delete[](void* bloque) noexcept { liberar(bloque); }
+void operator delete(void* bloque, size_t) noexcept { liberar(bloque); }
+void operator delete[](void* bloque, size_t) noexcept { liberar(bloque); }
+void operator delete(void* bloque, const nothrow_t&) noexcept { liberar(bloque); }
+void operator delete[](void* bloque, const nothrow_t&) noexcept { liberar(bloque); }
+void operator delete(void* bloque, align_val_t) noexcept { liberar(bloque); }
+void operator delete[](void* bloque, align_val_t) noexcept { liberar(bloque); }
+void operator delete(void* bloque, size_t, align_val_t) noexcept { liberar(bloque); }
+void operator delete[](void* bloque, size_t, align_val_t) noexcept { liberar(bloque); }
+void operator delete(void* bloque, align_val_t, const nothrow_t&) noexcept { liberar(bloque); }
+void operator delete[](void* bloque, align_val_t, const nothrow_t&) noexcept { liberar(bloque); }
@@ -1,4 +1,6 @@
 #include "operaciones.h"
+#include "operaciones_simd.h"
+#include "traza.h"
 #include <iostream>
 #include <cstring>
 
@@ -12,19 +14,33 @@
  * @return unsigned char* Imagen resultante tras aplicar XOR. El puntero debe liberarse con `delete[]`.
  */
 
-unsigned char* DoXOR(unsigned char* img1, unsigned char* img2, int width, int height) {
+unsigned char* DoXOR(const unsigned char* img1, const unsigned char* img2, int width, int height) {
     if (!img1 || !img2) return nullptr;
 
-    int totalPixels = width * height * 3;
-    unsigned char* result = new unsigned char[totalPixels];
-    if (!result) return nullptr;
-
-    for (int i = 0; i < totalPixels; i++) {
-        result[i] = img1[i] ^ img2[i];
-    }
+    unsigned char* result = new unsigned char[(size_t)width * height * 3];
+    DoXOR(img1, img2, result, width, height);
     return result;
 }
 
+/**
+ * @brief Aplica XOR pixel a pixel escribiendo en un buffer proporcionado por el llamador.
+ *
+ * @param img1 Puntero a la primera imagen (arreglo de bytes RGB).
+ * @param img2 Puntero a la segunda imagen (mismo tamaño que img1).
+ * @param destino Buffer de salida de `width * height * 3` bytes. Puede ser `img1` o `img2`.
+ * @param width Ancho de la imagen.
+ * @param height Alto de la imagen.
+ * @return false Si alguno de los punteros es nulo.
+ */
+
+bool DoXOR(const unsigned char* img1, const unsigned char* img2, unsigned char* destino, int width, int height) {
+    if (!img1 || !img2 || !destino) return false;
+    AmbitoTraza traza("kernel", "DoXOR", (long long)width * height * 3);
+
+    KernelsActivos().xorBytes(img1, img2, destino, (size_t)width * height * 3);
+    return true;
+}
+
 /**
  * @brief Rota cada byte de una imagen hacia la derecha (bitwise) una cantidad de bits.
  *
@@ -34,14 +50,31 @@ unsigned char* DoXOR(unsigned char* img1, unsigned char* img2, int width, int he
  * @return unsigned char* Imagen resultante tras rotación. El puntero debe liberarse con `delete[]`.
  */
 
-unsigned char* RotarDerecha(unsigned char* img, int num_pixels, int n) {
+unsigned char* RotarDerecha(const unsigned char* img, size_t num_pixels, int n) {
     unsigned char* result = new unsigned char[num_pixels * 3];
-    for (int i = 0; i < num_pixels * 3; i++) {
-        result[i] = (img[i] >> n) | (img[i] << (8 - n));
-    }
+    RotarDerecha(img, result, num_pixels, n);
     return result;
 }
 
+/**
+ * @brief Rota cada byte hacia la derecha escribiendo en un buffer proporcionado por el llamador.
+ *
+ * @param img Imagen de entrada (arreglo de bytes RGB).
+ * @param destino Buffer de salida de `num_pixels * 3` bytes. Puede ser `img`.
+ * @param num_pixels Número total de píxeles de la imagen.
+ * @param n Número de bits a rotar hacia la derecha.
+ * @return false Si alguno de los punteros es nulo.
+ */
+
+bool RotarDerecha(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n) {
+    if (!img || !destino) return false;
+    AmbitoTraza traza("kernel", "RotarDerecha", (long long)num_pixels * 3);
+
+    // Rotar n bits a la derecha equivale a rotar 8 - n bits a la izquierda
+    KernelsActivos().rotarIzquierdaBytes(img, destino, num_pixels * 3, (8 - n) & 7);
+    return true;
+}
+
 /**
  * @brief Rota cada byte de una imagen hacia la izquierda (bitwise) una cantidad de bits.
  *
@@ -51,14 +84,30 @@ unsigned char* RotarDerecha(unsigned char* img, int num_pixels, int n) {
  * @return unsigned char* Imagen resultante tras rotación. El puntero debe liberarse con `delete[]`.
  */
 
-unsigned char* RotarIzquierda(unsigned char* img, int num_pixels, int n) {
+unsigned char* RotarIzquierda(const unsigned char* img, size_t num_pixels, int n) {
     unsigned char* result = new unsigned char[num_pixels * 3];
-    for (int i = 0; i < num_pixels * 3; i++) {
-        result[i] = (img[i] << n) | (img[i] >> (8 - n));
-    }
+    RotarIzquierda(img, result, num_pixels, n);
     return result;
 }
 
+/**
+ * @brief Rota cada byte hacia la izquierda escribiendo en un buffer proporcionado por el llamador.
+ *
+ * @param img Imagen de entrada (arreglo de bytes RGB).
+ * @param destino Buffer de salida de `num_pixels * 3` bytes. Puede ser `img`.
+ * @param num_pixels Número total de píxeles de la imagen.
+ * @param n Número de bits a rotar hacia la izquierda.
+ * @return false Si alguno de los punteros es nulo.
+ */
+
+bool RotarIzquierda(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n) {
+    if (!img || !destino) return false;
+    AmbitoTraza traza("kernel", "RotarIzquierda", (long long)num_pixels * 3);
+
+    KernelsActivos().rotarIzquierdaBytes(img, destino, num_pixels * 3, n & 7);
+    return true;
+}
+
 /**
  * @brief Aplica una suma modular (mod 256) entre una imagen y una máscara, comenzando desde un desplazamiento.
  *
@@ -75,22 +124,123 @@ unsigned char* RotarIzquierda(unsigned char* img, int num_pixels, int n) {
  * @return unsigned char* Imagen resultante. El puntero debe liberarse con `delete[]`.
  */
 
-unsigned char* SumarMascara(unsigned char* img, unsigned char* mask, int width, int height, int mask_width, int mask_height, int offset) {
-    int totalPixels = width * height * 3;
-    unsigned char* result = new unsigned char[totalPixels];
+unsigned char* SumarMascara(const unsigned char* img, const unsigned char* mask, int width, int height, int mask_width, int mask_height, int offset) {
+    unsigned char* result = new unsigned char[(size_t)width * height * 3];
+    SumarMascara(img, mask, result, width, height, mask_width, mask_height, offset);
+    return result;
+}
+
+/**
+ * @brief Suma la máscara (mod 256) escribiendo en un buffer proporcionado por el llamador.
+ *
+ * Si `destino` es distinto de `img` primero copia la imagen completa; si es el mismo
+ * buffer solo modifica los bytes cubiertos por la máscara.
+ *
+ * @param img Imagen original (arreglo de bytes RGB).
+ * @param mask Máscara a sumar (arreglo de bytes RGB).
+ * @param destino Buffer de salida de `width * height * 3` bytes. Puede ser `img`.
+ * @param width Ancho de la imagen original.
+ * @param height Alto de la imagen original.
+ * @param mask_width Ancho de la máscara.
+ * @param mask_height Alto de la máscara.
+ * @param offset Desplazamiento dentro de la imagen donde se empezará a sumar la máscara.
+ * @return false Si alguno de los punteros es nulo.
+ */
+
+bool SumarMascara(const unsigned char* img, const unsigned char* mask, unsigned char* destino, int width, int height, int mask_width, int mask_height, int offset) {
+    if (!img || !mask || !destino) return false;
+    AmbitoTraza traza("kernel", "SumarMascara", (long long)width * height * 3);
+
+    size_t totalPixels = (size_t)width * height * 3;
 
     // Copiar la imagen original al resultado
-    for (int i = 0; i < totalPixels; i++) {
-        result[i] = img[i];
+    if (destino != img) memcpy(destino, img, totalPixels);
+
+    size_t maskSize = (size_t)mask_width * mask_height * 3;
+    if (offset < 0 || (size_t)offset >= totalPixels) return true;
+
+    // La suma de bytes sin signo ya es módulo 256
+    size_t n = totalPixels - offset < maskSize ? totalPixels - offset : maskSize;
+    KernelsActivos().sumarBytes(img + offset, mask, destino + offset, n);
+
+    return true;
+}
+
+// Las vistas deben describir el mismo rectangulo de pixeles
+static bool mismasDimensiones(const VistaLectura& a, const VistaLectura& b) {
+    return a.ancho == b.ancho && a.alto == b.alto && a.canales == b.canales;
+}
+
+/**
+ * @brief XOR entre dos vistas. Si alguna no es contigua se procesa fila por fila.
+ *
+ * @return false Si las vistas estan vacias o no tienen las mismas dimensiones.
+ */
+
+bool DoXOR(const VistaLectura& img1, const VistaLectura& img2, const VistaImagen& destino) {
+    if (img1.vacia() || !mismasDimensiones(img1, img2) || !mismasDimensiones(img1, destino)) return false;
+    AmbitoTraza traza("kernel", "DoXOR", (long long)img1.bytes());
+    const KernelsOperaciones& kernels = KernelsActivos();
+
+    if (img1.contigua() && img2.contigua() && destino.contigua()) {
+        kernels.xorBytes(img1.datos, img2.datos, destino.datos, img1.bytes());
+        return true;
     }
+    for (int y = 0; y < img1.alto; y++) {
+        kernels.xorBytes(img1.fila(y), img2.fila(y), destino.fila(y), img1.bytesFila());
+    }
+    return true;
+}
 
-    int maskSize = mask_width * mask_height * 3;
-    int pos = offset;
+// Rota cada byte de la vista `bits` bits a la izquierda (0 a 7)
+static bool rotarVista(const VistaLectura& img, const VistaImagen& destino, int bits) {
+    if (img.vacia() || !mismasDimensiones(img, destino)) return false;
+    const KernelsOperaciones& kernels = KernelsActivos();
 
-    for (int k = 0; k < maskSize && pos + k < totalPixels; k++) {
-        // Suma con módulo 256 (sin overflow)
-        result[pos + k] = (img[pos + k] + mask[k]) % 256;
+    if (img.contigua() && destino.contigua()) {
+        kernels.rotarIzquierdaBytes(img.datos, destino.datos, img.bytes(), bits);
+        return true;
+    }
+    for (int y = 0; y < img.alto; y++) {
+        kernels.rotarIzquierdaBytes(img.fila(y), destino.fila(y), img.bytesFila(), bits);
     }
+    return true;
+}
 
-    return result;
+/**
+ * @brief Rotacion derecha de `n` bits sobre vistas (ver `RotarDerecha`).
+ */
+
+bool RotarDerecha(const VistaLectura& img, const VistaImagen& destino, int n) {
+    AmbitoTraza traza("kernel", "RotarDerecha", (long long)img.bytes());
+    return rotarVista(img, destino, (8 - n) & 7);
+}
+
+/**
+ * @brief Rotacion izquierda de `n` bits sobre vistas (ver `RotarIzquierda`).
+ */
+
+bool RotarIzquierda(const VistaLectura& img, const VistaImagen& destino, int n) {
+    AmbitoTraza traza("kernel", "RotarIzquierda", (long long)img.bytes());
+    return rotarVista(img, destino, n & 7);
+}
+
+/**
+ * @brief Suma de la mascara sobre vistas contiguas, a partir del byte `offset` (ver `SumarMascara`).
+ *
+ * @return false Si las vistas estan vacias, no son contiguas o `img` y `destino` difieren en tamaño.
+ */
+
+bool SumarMascara(const VistaLectura& img, const VistaLectura& mask, const VistaImagen& destino, size_t offset) {
+    if (img.vacia() || mask.vacia() || !mismasDimensiones(img, destino)) return false;
+    if (!img.contigua() || !mask.contigua() || !destino.contigua()) return false;
+    AmbitoTraza traza("kernel", "SumarMascara", (long long)img.bytes());
+
+    size_t totalBytes = img.bytes();
+    if (destino.datos != img.datos) memcpy(destino.datos, img.datos, totalBytes);
+    if (offset >= totalBytes) return true;
+
+    size_t n = totalBytes - offset < mask.bytes() ? totalBytes - offset : mask.bytes();
+    KernelsActivos().sumarBytes(img.datos + offset, mask.datos, destino.datos + offset, n);
+    return true;
 }
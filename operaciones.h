@@ -1,11 +1,48 @@
 #ifndef OPERACIONES_H
 #define OPERACIONES_H
 
+#include <cstddef>
+
+#include "imagen.h"
+
 const int MAX_BITS = 8;
 
-unsigned char* DoXOR(unsigned char* img1, unsigned char* img2, int width, int height);
-unsigned char* RotarDerecha(unsigned char* img, int num_pixels, int n);
-unsigned char* RotarIzquierda(unsigned char* img, int num_pixels, int n);
-unsigned char* SumarMascara(unsigned char* img, unsigned char* mask, int width, int height, int mask_width, int mask_height, int offset);
+unsigned char* DoXOR(const unsigned char* img1, const unsigned char* img2, int width, int height);
+unsigned char* RotarDerecha(const unsigned char* img, size_t num_pixels, int n);
+unsigned char* RotarIzquierda(const unsigned char* img, size_t num_pixels, int n);
+unsigned char* SumarMascara(const unsigned char* img, const unsigned char* mask, int width, int height, int mask_width, int mask_height, int offset);
+
+// Variantes que escriben en un buffer del llamador (puede ser la misma entrada)
+bool DoXOR(const unsigned char* img1, const unsigned char* img2, unsigned char* destino, int width, int height);
+bool RotarDerecha(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n);
+bool RotarIzquierda(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n);
+bool SumarMascara(const unsigned char* img, const unsigned char* mask, unsigned char* destino, int width, int height, int mask_width, int mask_height, int offset);
+
+// Variantes sobre vistas: entrada y destino con las mismas dimensiones (el destino puede ser la entrada)
+bool DoXOR(const VistaLectura& img1, const VistaLectura& img2, const VistaImagen& destino);
+bool RotarDerecha(const VistaLectura& img, const VistaImagen& destino, int n);
+bool RotarIzquierda(const VistaLectura& img, const VistaImagen& destino, int n);
+bool SumarMascara(const VistaLectura& img, const VistaLectura& mask, const VistaImagen& destino, size_t offset);
+
+/**
+ * @brief Aplica a un unico byte la operacion inversa identificada por su codigo.
+ *
+ * Usa la misma codificacion que PlanificarReconstruccion: 1 para XOR,
+ * 2X para rotacion izquierda de X bits y 3X para rotacion derecha de X bits.
+ * Cualquier otro codigo deja el byte sin cambios.
+ */
+inline unsigned char AplicarOperacionByte(unsigned char valor, unsigned char im, int operacion) {
+    int n = operacion % 10;
+    switch (operacion / 10) {
+    case 0:
+        return valor ^ im;
+    case 2:
+        return (unsigned char)((valor << n) | (valor >> (8 - n)));
+    case 3:
+        return (unsigned char)((valor >> n) | (valor << (8 - n)));
+    default:
+        return valor;
+    }
+}
 
 #endif // OPERACIONES_H
@@ -0,0 +1,139 @@
+#include "operaciones_paralelas.h"
+#include "hilos.h"
+#include "operaciones.h"
+#include "operaciones_simd.h"
+#include "traza.h"
+#include <cstring>
+
+using namespace std;
+
+/**
+ * @brief Ejecuta `trabajo(inicio, n)` sobre bandas consecutivas de `bytesBanda` bytes que cubren `totalBytes`.
+ *
+ * Las bandas son disjuntas, por lo que `trabajo` puede escribir en su rango sin
+ * sincronizarse. Si `totalBytes` es menor que `minBytes` o el pool tiene un solo
+ * hilo, se llama una vez con el rango completo. El hilo que llama procesa
+ * la ultima banda y despues ayuda con las pendientes mientras espera, asi tambien se
+ * puede usar desde dentro de una tarea del pool. Si alguna banda lanza una excepcion,
+ * se propaga despues de que terminen todas.
+ */
+void RepartirEnBandas(size_t totalBytes, const function<void(size_t inicio, size_t n)>& trabajo, size_t bytesBanda, size_t minBytes) {
+    PoolHilos& pool = PoolHilos::global();
+    if (totalBytes < minBytes || totalBytes <= bytesBanda || pool.numHilos() < 2) {
+        if (totalBytes > 0) trabajo(0, totalBytes);
+        return;
+    }
+
+    size_t numBandas = (totalBytes + bytesBanda - 1) / bytesBanda;
+    GrupoTareas grupo;
+    for (size_t b = 0; b + 1 < numBandas; b++) {
+        size_t inicio = b * bytesBanda;
+        pool.encolar(grupo, [&trabajo, inicio, bytesBanda] {
+            trabajo(inicio, bytesBanda);
+        });
+    }
+    size_t ultima = (numBandas - 1) * bytesBanda;
+    try {
+        trabajo(ultima, totalBytes - ultima);
+    } catch (...) {
+        // Las tareas encoladas usan `trabajo` y `grupo`: esperarlas antes de salir
+        try {
+            pool.esperar(grupo);
+        } catch (...) {
+        }
+        throw;
+    }
+    pool.esperar(grupo);
+}
+
+/**
+ * @brief Como `DoXOR`, repartiendo la imagen en bandas entre los hilos del pool.
+ *
+ * @see DoXOR, RepartirEnBandas
+ */
+bool DoXORParalelo(const unsigned char* img1, const unsigned char* img2, unsigned char* destino, int width, int height) {
+    if (!img1 || !img2 || !destino) return false;
+    AmbitoTraza traza("kernel", "DoXORParalelo", (long long)width * height * 3);
+
+    const KernelsOperaciones& kernels = KernelsActivos();
+    RepartirEnBandas((size_t)width * height * 3, [&](size_t inicio, size_t n) {
+        kernels.xorBytes(img1 + inicio, img2 + inicio, destino + inicio, n);
+    });
+    return true;
+}
+
+// Rota cada byte `bits` bits a la izquierda (0 a 7) repartiendo el trabajo en bandas
+static void rotarParalelo(const unsigned char* img, unsigned char* destino, size_t totalBytes, int bits) {
+    const KernelsOperaciones& kernels = KernelsActivos();
+    RepartirEnBandas(totalBytes, [&](size_t inicio, size_t n) {
+        kernels.rotarIzquierdaBytes(img + inicio, destino + inicio, n, bits);
+    });
+}
+
+/**
+ * @brief Como `RotarDerecha`, repartiendo la imagen en bandas entre los hilos del pool.
+ *
+ * @see RotarDerecha, RepartirEnBandas
+ */
+bool RotarDerechaParalelo(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n) {
+    if (!img || !destino) return false;
+    AmbitoTraza traza("kernel", "RotarDerechaParalelo", (long long)num_pixels * 3);
+
+    // Rotar n bits a la derecha equivale a rotar 8 - n bits a la izquierda
+    rotarParalelo(img, destino, num_pixels * 3, (8 - n) & 7);
+    return true;
+}
+
+/**
+ * @brief Como `RotarIzquierda`, repartiendo la imagen en bandas entre los hilos del pool.
+ *
+ * @see RotarIzquierda, RepartirEnBandas
+ */
+bool RotarIzquierdaParalelo(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n) {
+    if (!img || !destino) return false;
+    AmbitoTraza traza("kernel", "RotarIzquierdaParalelo", (long long)num_pixels * 3);
+
+    rotarParalelo(img, destino, num_pixels * 3, n & 7);
+    return true;
+}
+
+/**
+ * @brief Como `SumarMascara`, repartiendo la imagen en bandas entre los hilos del pool.
+ *
+ * Cada banda copia su parte de la imagen (si `destino` no es `img`) y suma la parte de
+ * la mascara que cae dentro de ella.
+ *
+ * @see SumarMascara, RepartirEnBandas
+ */
+bool SumarMascaraParalelo(const unsigned char* img, const unsigned char* mask, unsigned char* destino, int width, int height, int mask_width, int mask_height, int offset) {
+    if (!img || !mask || !destino) return false;
+    AmbitoTraza traza("kernel", "SumarMascaraParalelo", (long long)width * height * 3);
+
+    size_t totalPixels = (size_t)width * height * 3;
+    size_t maskSize = (size_t)mask_width * mask_height * 3;
+
+    // Rango de la imagen cubierto por la mascara (vacio si el desplazamiento queda fuera)
+    size_t inicioMascara = 0, finMascara = 0;
+    if (offset >= 0 && (size_t)offset < totalPixels) {
+        inicioMascara = (size_t)offset;
+        finMascara = totalPixels - inicioMascara < maskSize ? totalPixels : inicioMascara + maskSize;
+    }
+
+    // Si el destino es la entrada solo hay que tocar los bytes de la mascara
+    size_t inicioTrabajo = destino == img ? inicioMascara : 0;
+    size_t finTrabajo = destino == img ? finMascara : totalPixels;
+
+    const KernelsOperaciones& kernels = KernelsActivos();
+    RepartirEnBandas(finTrabajo - inicioTrabajo, [&](size_t inicio, size_t n) {
+        inicio += inicioTrabajo;
+        size_t fin = inicio + n;
+        if (destino != img) memcpy(destino + inicio, img + inicio, n);
+
+        size_t desde = inicio > inicioMascara ? inicio : inicioMascara;
+        size_t hasta = fin < finMascara ? fin : finMascara;
+        if (desde < hasta) {
+            kernels.sumarBytes(img + desde, mask + (desde - inicioMascara), destino + desde, hasta - desde);
+        }
+    });
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef OPERACIONES_PARALELAS_H
+#define OPERACIONES_PARALELAS_H
+
+#include <cstddef>
+#include <functional>
+
+/**
+ * Versiones multihilo de los nucleos de imagen completa de operaciones.h.
+ *
+ * La imagen se reparte en bandas de `BYTES_BANDA_PARALELA` bytes que se procesan en el
+ * `PoolHilos` global; cada banda usa los mismos nucleos que la version de un hilo, asi
+ * la salida es identica byte a byte. Por debajo de `MIN_BYTES_PARALELO` no compensa
+ * repartir el trabajo y se llama directamente a la version de un hilo.
+ */
+
+const size_t BYTES_BANDA_PARALELA = 256 * 1024;  // cabe en la L2 de un nucleo
+const size_t MIN_BYTES_PARALELO = 2 * 1024 * 1024;
+
+void RepartirEnBandas(size_t totalBytes, const std::function<void(size_t inicio, size_t n)>& trabajo,
+                      size_t bytesBanda = BYTES_BANDA_PARALELA, size_t minBytes = MIN_BYTES_PARALELO);
+
+bool DoXORParalelo(const unsigned char* img1, const unsigned char* img2, unsigned char* destino, int width, int height);
+bool RotarDerechaParalelo(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n);
+bool RotarIzquierdaParalelo(const unsigned char* img, unsigned char* destino, size_t num_pixels, int n);
+bool SumarMascaraParalelo(const unsigned char* img, const unsigned char* mask, unsigned char* destino, int width, int height, int mask_width, int mask_height, int offset);
+
+#endif // OPERACIONES_PARALELAS_H
@@ -0,0 +1,482 @@
+#include "operaciones_simd.h"
+#include <atomic>
+#include <bitset>
+#include <cstdlib>
+#include <cstring>
+
+#include "registro.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OPERACIONES_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define OPERACIONES_TARGET(x)
+#else
+#define OPERACIONES_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+// ---------------------------------------------------------------------------
+// Version escalar (referencia)
+// ---------------------------------------------------------------------------
+
+static void xorBytesEscalar(const unsigned char* a, const unsigned char* b, unsigned char* destino, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        destino[i] = a[i] ^ b[i];
+    }
+}
+
+static void rotarIzquierdaBytesEscalar(const unsigned char* img, unsigned char* destino, size_t n, int bits) {
+    int r = bits & 7;
+    for (size_t i = 0; i < n; i++) {
+        destino[i] = (unsigned char)((img[i] << r) | (img[i] >> ((8 - r) & 7)));
+    }
+}
+
+static void sumarBytesEscalar(const unsigned char* img, const unsigned char* mask, unsigned char* destino, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        destino[i] = (unsigned char)(img[i] + mask[i]);
+    }
+}
+
+// Claves del digesto, una por acumulador (las mismas constantes que usa XXH3)
+alignas(64) static const uint64_t CLAVES_DIGESTO[NUM_ACUMULADORES_DIGESTO] = {
+    0xbe4ba423396cfeb8ull, 0x1cad21f72c81017cull, 0xdb979083e96dd4deull, 0x1f67b3b7a4a44072ull
+};
+// Por cada franja las claves avanzan este primo (PRIME64_1 de XXH3)
+static const uint64_t PRIMO_FRANJA_DIGESTO = 0x9E3779B185EBCA87ull;
+
+static uint64_t leer64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// Cada acumulador suma su palabra de la franja mas el producto de las dos mitades de
+// 32 bits de la palabra mezclada con su clave, desplazada segun la posicion de la
+// franja: dos franjas intercambiadas dan otro resultado. Como cada termino ya incluye
+// su posicion, el orden en que se suman no importa: las variantes SIMD pueden llevar
+// mas acumuladores y sumarlos al final.
+static void acumularDigestoEscalar(uint64_t* acumuladores, const unsigned char* datos, size_t numFranjas, uint64_t primeraFranja) {
+    for (size_t f = 0; f < numFranjas; f++) {
+        const unsigned char* franja = datos + f * BYTES_FRANJA_DIGESTO;
+        uint64_t desplazamiento = (primeraFranja + f) * PRIMO_FRANJA_DIGESTO;
+        for (int i = 0; i < NUM_ACUMULADORES_DIGESTO; i++) {
+            uint64_t v = leer64(franja + 8 * i);
+            uint64_t k = v ^ (CLAVES_DIGESTO[i] + desplazamiento);
+            acumuladores[i] += v + (k & 0xFFFFFFFFull) * (k >> 32);
+        }
+    }
+}
+
+static size_t contarDiferenciasEscalar(const unsigned char* a, const unsigned char* b, size_t n, size_t* primera) {
+    size_t distintos = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != b[i]) {
+            if (distintos == 0) *primera = i;
+            distintos++;
+        }
+    }
+    return distintos;
+}
+
+// Suma al conteo los bytes distintos de un bloque (bit en 1 = byte distinto)
+static void registrarDiferencias(uint64_t bitsDistintos, size_t inicioBloque, size_t& distintos, size_t* primera) {
+    if (distintos == 0) {
+        int bit = 0;
+        while (!(bitsDistintos & (1ull << bit))) bit++;
+        *primera = inicioBloque + bit;
+    }
+    distintos += std::bitset<64>(bitsDistintos).count();
+}
+
+static const KernelsOperaciones kernelsEscalar = {
+    "escalar", xorBytesEscalar, rotarIzquierdaBytesEscalar, sumarBytesEscalar,
+    acumularDigestoEscalar, contarDiferenciasEscalar
+};
+
+#ifdef OPERACIONES_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 (16 bytes por iteracion)
+// ---------------------------------------------------------------------------
+
+OPERACIONES_TARGET("sse2")
+static void xorBytesSSE2(const unsigned char* a, const unsigned char* b, unsigned char* destino, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(destino + i), _mm_xor_si128(va, vb));
+    }
+    xorBytesEscalar(a + i, b + i, destino + i, n - i);
+}
+
+// No hay desplazamientos de 8 bits: se desplazan palabras de 16 bits y se
+// enmascaran los bits que cruzan de un byte al vecino.
+OPERACIONES_TARGET("sse2")
+static void rotarIzquierdaBytesSSE2(const unsigned char* img, unsigned char* destino, size_t n, int bits) {
+    int r = bits & 7;
+    if (r == 0) {
+        if (destino != img) memmove(destino, img, n);
+        return;
+    }
+    __m128i cuentaIzq = _mm_cvtsi32_si128(r);
+    __m128i cuentaDer = _mm_cvtsi32_si128(8 - r);
+    __m128i mascaraIzq = _mm_set1_epi8((char)((0xFF << r) & 0xFF));
+    __m128i mascaraDer = _mm_set1_epi8((char)(0xFF >> (8 - r)));
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(img + i));
+        __m128i izq = _mm_and_si128(_mm_sll_epi16(v, cuentaIzq), mascaraIzq);
+        __m128i der = _mm_and_si128(_mm_srl_epi16(v, cuentaDer), mascaraDer);
+        _mm_storeu_si128((__m128i*)(destino + i), _mm_or_si128(izq, der));
+    }
+    rotarIzquierdaBytesEscalar(img + i, destino + i, n - i, r);
+}
+
+OPERACIONES_TARGET("sse2")
+static void sumarBytesSSE2(const unsigned char* img, const unsigned char* mask, unsigned char* destino, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(img + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(mask + i));
+        _mm_storeu_si128((__m128i*)(destino + i), _mm_add_epi8(va, vb));
+    }
+    sumarBytesEscalar(img + i, mask + i, destino + i, n - i);
+}
+
+// _mm_mul_epu32 multiplica las mitades bajas de 32 bits de cada palabra de 64 bits
+OPERACIONES_TARGET("sse2")
+static void acumularDigestoSSE2(uint64_t* acumuladores, const unsigned char* datos, size_t numFranjas, uint64_t primeraFranja) {
+    __m128i acc0 = _mm_loadu_si128((const __m128i*)acumuladores);
+    __m128i acc1 = _mm_loadu_si128((const __m128i*)(acumuladores + 2));
+    __m128i desplazamiento = _mm_set1_epi64x((long long)(primeraFranja * PRIMO_FRANJA_DIGESTO));
+    __m128i paso = _mm_set1_epi64x((long long)PRIMO_FRANJA_DIGESTO);
+    __m128i clave0 = _mm_add_epi64(_mm_load_si128((const __m128i*)CLAVES_DIGESTO), desplazamiento);
+    __m128i clave1 = _mm_add_epi64(_mm_load_si128((const __m128i*)(CLAVES_DIGESTO + 2)), desplazamiento);
+
+    for (size_t f = 0; f < numFranjas; f++) {
+        const unsigned char* franja = datos + f * BYTES_FRANJA_DIGESTO;
+        __m128i v0 = _mm_loadu_si128((const __m128i*)franja);
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(franja + 16));
+        __m128i k0 = _mm_xor_si128(v0, clave0);
+        __m128i k1 = _mm_xor_si128(v1, clave1);
+        acc0 = _mm_add_epi64(acc0, _mm_add_epi64(v0, _mm_mul_epu32(k0, _mm_srli_epi64(k0, 32))));
+        acc1 = _mm_add_epi64(acc1, _mm_add_epi64(v1, _mm_mul_epu32(k1, _mm_srli_epi64(k1, 32))));
+        clave0 = _mm_add_epi64(clave0, paso);
+        clave1 = _mm_add_epi64(clave1, paso);
+    }
+    _mm_storeu_si128((__m128i*)acumuladores, acc0);
+    _mm_storeu_si128((__m128i*)(acumuladores + 2), acc1);
+}
+
+OPERACIONES_TARGET("sse2")
+static size_t contarDiferenciasSSE2(const unsigned char* a, const unsigned char* b, size_t n, size_t* primera) {
+    size_t distintos = 0;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i iguales = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        unsigned int bits = ~(unsigned int)_mm_movemask_epi8(iguales) & 0xFFFFu;
+        if (bits) registrarDiferencias(bits, i, distintos, primera);
+    }
+    size_t primeraResto = 0;
+    size_t resto = contarDiferenciasEscalar(a + i, b + i, n - i, &primeraResto);
+    if (resto && distintos == 0) *primera = i + primeraResto;
+    return distintos + resto;
+}
+
+static const KernelsOperaciones kernelsSSE2 = {
+    "sse2", xorBytesSSE2, rotarIzquierdaBytesSSE2, sumarBytesSSE2,
+    acumularDigestoSSE2, contarDiferenciasSSE2
+};
+
+// ---------------------------------------------------------------------------
+// AVX2 (32 bytes por iteracion)
+// ---------------------------------------------------------------------------
+
+OPERACIONES_TARGET("avx2")
+static void xorBytesAVX2(const unsigned char* a, const unsigned char* b, unsigned char* destino, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(destino + i), _mm256_xor_si256(va, vb));
+    }
+    xorBytesEscalar(a + i, b + i, destino + i, n - i);
+}
+
+OPERACIONES_TARGET("avx2")
+static void rotarIzquierdaBytesAVX2(const unsigned char* img, unsigned char* destino, size_t n, int bits) {
+    int r = bits & 7;
+    if (r == 0) {
+        if (destino != img) memmove(destino, img, n);
+        return;
+    }
+    __m128i cuentaIzq = _mm_cvtsi32_si128(r);
+    __m128i cuentaDer = _mm_cvtsi32_si128(8 - r);
+    __m256i mascaraIzq = _mm256_set1_epi8((char)((0xFF << r) & 0xFF));
+    __m256i mascaraDer = _mm256_set1_epi8((char)(0xFF >> (8 - r)));
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(img + i));
+        __m256i izq = _mm256_and_si256(_mm256_sll_epi16(v, cuentaIzq), mascaraIzq);
+        __m256i der = _mm256_and_si256(_mm256_srl_epi16(v, cuentaDer), mascaraDer);
+        _mm256_storeu_si256((__m256i*)(destino + i), _mm256_or_si256(izq, der));
+    }
+    rotarIzquierdaBytesEscalar(img + i, destino + i, n - i, r);
+}
+
+OPERACIONES_TARGET("avx2")
+static void sumarBytesAVX2(const unsigned char* img, const unsigned char* mask, unsigned char* destino, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(img + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(mask + i));
+        _mm256_storeu_si256((__m256i*)(destino + i), _mm256_add_epi8(va, vb));
+    }
+    sumarBytesEscalar(img + i, mask + i, destino + i, n - i);
+}
+
+OPERACIONES_TARGET("avx2")
+static void acumularDigestoAVX2(uint64_t* acumuladores, const unsigned char* datos, size_t numFranjas, uint64_t primeraFranja) {
+    __m256i acc = _mm256_loadu_si256((const __m256i*)acumuladores);
+    __m256i paso = _mm256_set1_epi64x((long long)PRIMO_FRANJA_DIGESTO);
+    __m256i clave = _mm256_add_epi64(_mm256_load_si256((const __m256i*)CLAVES_DIGESTO),
+                                     _mm256_set1_epi64x((long long)(primeraFranja * PRIMO_FRANJA_DIGESTO)));
+
+    for (size_t f = 0; f < numFranjas; f++) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(datos + f * BYTES_FRANJA_DIGESTO));
+        __m256i k = _mm256_xor_si256(v, clave);
+        acc = _mm256_add_epi64(acc, _mm256_add_epi64(v, _mm256_mul_epu32(k, _mm256_srli_epi64(k, 32))));
+        clave = _mm256_add_epi64(clave, paso);
+    }
+    _mm256_storeu_si256((__m256i*)acumuladores, acc);
+}
+
+OPERACIONES_TARGET("avx2")
+static size_t contarDiferenciasAVX2(const unsigned char* a, const unsigned char* b, size_t n, size_t* primera) {
+    size_t distintos = 0;
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i iguales = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+        unsigned int bits = ~(unsigned int)_mm256_movemask_epi8(iguales);
+        if (bits) registrarDiferencias(bits, i, distintos, primera);
+    }
+    size_t primeraResto = 0;
+    size_t resto = contarDiferenciasEscalar(a + i, b + i, n - i, &primeraResto);
+    if (resto && distintos == 0) *primera = i + primeraResto;
+    return distintos + resto;
+}
+
+static const KernelsOperaciones kernelsAVX2 = {
+    "avx2", xorBytesAVX2, rotarIzquierdaBytesAVX2, sumarBytesAVX2,
+    acumularDigestoAVX2, contarDiferenciasAVX2
+};
+
+// ---------------------------------------------------------------------------
+// AVX-512BW (64 bytes por iteracion)
+// ---------------------------------------------------------------------------
+
+OPERACIONES_TARGET("avx512f,avx512bw")
+static void xorBytesAVX512(const unsigned char* a, const unsigned char* b, unsigned char* destino, size_t n) {
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i va = _mm512_loadu_si512((const void*)(a + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(b + i));
+        _mm512_storeu_si512((void*)(destino + i), _mm512_xor_si512(va, vb));
+    }
+    xorBytesEscalar(a + i, b + i, destino + i, n - i);
+}
+
+OPERACIONES_TARGET("avx512f,avx512bw")
+static void rotarIzquierdaBytesAVX512(const unsigned char* img, unsigned char* destino, size_t n, int bits) {
+    int r = bits & 7;
+    if (r == 0) {
+        if (destino != img) memmove(destino, img, n);
+        return;
+    }
+    __m128i cuentaIzq = _mm_cvtsi32_si128(r);
+    __m128i cuentaDer = _mm_cvtsi32_si128(8 - r);
+    __m512i mascaraIzq = _mm512_set1_epi8((char)((0xFF << r) & 0xFF));
+    __m512i mascaraDer = _mm512_set1_epi8((char)(0xFF >> (8 - r)));
+
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i v = _mm512_loadu_si512((const void*)(img + i));
+        __m512i izq = _mm512_and_si512(_mm512_sll_epi16(v, cuentaIzq), mascaraIzq);
+        __m512i der = _mm512_and_si512(_mm512_srl_epi16(v, cuentaDer), mascaraDer);
+        _mm512_storeu_si512((void*)(destino + i), _mm512_or_si512(izq, der));
+    }
+    rotarIzquierdaBytesEscalar(img + i, destino + i, n - i, r);
+}
+
+OPERACIONES_TARGET("avx512f,avx512bw")
+static void sumarBytesAVX512(const unsigned char* img, const unsigned char* mask, unsigned char* destino, size_t n) {
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m512i va = _mm512_loadu_si512((const void*)(img + i));
+        __m512i vb = _mm512_loadu_si512((const void*)(mask + i));
+        _mm512_storeu_si512((void*)(destino + i), _mm512_add_epi8(va, vb));
+    }
+    sumarBytesEscalar(img + i, mask + i, destino + i, n - i);
+}
+
+// Dos franjas por iteracion: la mitad alta de `acc` acumula las franjas impares y al
+// final se suma a la baja. Las claves de la mitad alta van una franja adelantadas.
+OPERACIONES_TARGET("avx512f,avx512bw")
+static void acumularDigestoAVX512(uint64_t* acumuladores, const unsigned char* datos, size_t numFranjas, uint64_t primeraFranja) {
+    uint64_t pares[2 * NUM_ACUMULADORES_DIGESTO] = {};
+    for (int i = 0; i < NUM_ACUMULADORES_DIGESTO; i++) {
+        pares[i] = CLAVES_DIGESTO[i] + primeraFranja * PRIMO_FRANJA_DIGESTO;
+        pares[i + NUM_ACUMULADORES_DIGESTO] = CLAVES_DIGESTO[i] + (primeraFranja + 1) * PRIMO_FRANJA_DIGESTO;
+    }
+    __m512i clave = _mm512_loadu_si512((const void*)pares);
+    __m512i paso = _mm512_set1_epi64((long long)(2 * PRIMO_FRANJA_DIGESTO));
+    __m512i acc = _mm512_setzero_si512();
+
+    size_t f = 0;
+    for (; f + 2 <= numFranjas; f += 2) {
+        __m512i v = _mm512_loadu_si512((const void*)(datos + f * BYTES_FRANJA_DIGESTO));
+        __m512i k = _mm512_xor_si512(v, clave);
+        // Variantes maskz con todos los carriles: las normales hacen que GCC 12 avise de
+        // un valor sin inicializar dentro de sus propios encabezados
+        __m512i alta = _mm512_maskz_srli_epi64((__mmask8)0xFF, k, 32);
+        acc = _mm512_add_epi64(acc, _mm512_add_epi64(v, _mm512_maskz_mul_epu32((__mmask8)0xFF, k, alta)));
+        clave = _mm512_add_epi64(clave, paso);
+    }
+    _mm512_storeu_si512((void*)pares, acc);
+    for (int i = 0; i < NUM_ACUMULADORES_DIGESTO; i++) {
+        acumuladores[i] += pares[i] + pares[i + NUM_ACUMULADORES_DIGESTO];
+    }
+    acumularDigestoEscalar(acumuladores, datos + f * BYTES_FRANJA_DIGESTO, numFranjas - f, primeraFranja + f);
+}
+
+OPERACIONES_TARGET("avx512f,avx512bw")
+static size_t contarDiferenciasAVX512(const unsigned char* a, const unsigned char* b, size_t n, size_t* primera) {
+    size_t distintos = 0;
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __mmask64 bits = _mm512_cmpneq_epi8_mask(_mm512_loadu_si512((const void*)(a + i)), _mm512_loadu_si512((const void*)(b + i)));
+        if (bits) registrarDiferencias(bits, i, distintos, primera);
+    }
+    size_t primeraResto = 0;
+    size_t resto = contarDiferenciasEscalar(a + i, b + i, n - i, &primeraResto);
+    if (resto && distintos == 0) *primera = i + primeraResto;
+    return distintos + resto;
+}
+
+static const KernelsOperaciones kernelsAVX512 = {
+    "avx512", xorBytesAVX512, rotarIzquierdaBytesAVX512, sumarBytesAVX512,
+    acumularDigestoAVX512, contarDiferenciasAVX512
+};
+
+// ---------------------------------------------------------------------------
+// Deteccion de CPU
+// ---------------------------------------------------------------------------
+
+#if defined(_MSC_VER) && !defined(__clang__)
+static bool cpuSoporta(const char* extension) {
+    int info[4];
+    __cpuid(info, 0);
+    int maxHoja = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (strcmp(extension, "sse2") == 0) return sse2;
+    if (!osxsave || maxHoja < 7) return false;
+
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if (strcmp(extension, "avx2") == 0) {
+        return (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+    }
+    if (strcmp(extension, "avx512bw") == 0) {
+        return (xcr0 & 0xE6) == 0xE6 && (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0;
+    }
+    return false;
+}
+#else
+static bool cpuSoporta(const char* extension) {
+    __builtin_cpu_init();
+    if (strcmp(extension, "sse2") == 0) return __builtin_cpu_supports("sse2");
+    if (strcmp(extension, "avx2") == 0) return __builtin_cpu_supports("avx2");
+    if (strcmp(extension, "avx512bw") == 0) {
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+    return false;
+}
+#endif
+
+#endif // OPERACIONES_X86
+
+// Variante con ese nombre, o nullptr si no existe o la CPU no la soporta
+static const KernelsOperaciones* kernelsPorNombre(const char* nombre) {
+    if (strcmp(nombre, "escalar") == 0) return &kernelsEscalar;
+#ifdef OPERACIONES_X86
+    if (strcmp(nombre, "sse2") == 0 && cpuSoporta("sse2")) return &kernelsSSE2;
+    if (strcmp(nombre, "avx2") == 0 && cpuSoporta("avx2")) return &kernelsAVX2;
+    if (strcmp(nombre, "avx512") == 0 && cpuSoporta("avx512bw")) return &kernelsAVX512;
+#endif
+    return nullptr;
+}
+
+static const KernelsOperaciones* mejoresKernels() {
+#ifdef OPERACIONES_X86
+    if (cpuSoporta("avx512bw")) return &kernelsAVX512;
+    if (cpuSoporta("avx2")) return &kernelsAVX2;
+    if (cpuSoporta("sse2")) return &kernelsSSE2;
+#endif
+    return &kernelsEscalar;
+}
+
+/**
+ * @brief Devuelve la mejor variante soportada por la CPU (o la pedida en DESAFIO_SIMD).
+ *
+ * Si DESAFIO_SIMD nombra una variante desconocida o que la CPU no soporta se avisa y
+ * se usa la mejor disponible, para que una comparacion no mida otra variante sin saberlo.
+ */
+static const KernelsOperaciones* detectarKernels() {
+    const char* forzado = getenv("DESAFIO_SIMD");
+    if (!forzado || !*forzado) return mejoresKernels();
+
+    const KernelsOperaciones* pedidos = kernelsPorNombre(forzado);
+    if (pedidos) return pedidos;
+    const KernelsOperaciones* mejores = mejoresKernels();
+    REGISTRO_AVISO << "Aviso: DESAFIO_SIMD=" << forzado << " no es una variante conocida o la CPU no la soporta"
+                   << " (se aceptan escalar, sse2, avx2 y avx512); se usa " << mejores->nombre << '\n';
+    return mejores;
+}
+
+static std::atomic<const KernelsOperaciones*> kernelsSeleccionados(nullptr);
+
+/**
+ * @brief Devuelve los nucleos elegidos para esta CPU. La deteccion se hace una sola vez.
+ */
+const KernelsOperaciones& KernelsActivos() {
+    const KernelsOperaciones* k = kernelsSeleccionados.load(std::memory_order_acquire);
+    if (!k) {
+        // Una sola deteccion (y un solo aviso) aunque varios hilos lleguen a la vez; si
+        // mientras tanto se llamo a SeleccionarKernels, gana esa eleccion
+        static const KernelsOperaciones* const detectados = detectarKernels();
+        const KernelsOperaciones* anterior = nullptr;
+        kernelsSeleccionados.compare_exchange_strong(anterior, detectados, std::memory_order_acq_rel);
+        k = anterior ? anterior : detectados;
+    }
+    return *k;
+}
+
+/**
+ * @brief Fuerza una variante concreta ("escalar", "sse2", "avx2" o "avx512").
+ *
+ * @return false Si la variante no existe o la CPU no la soporta (no cambia nada).
+ */
+bool SeleccionarKernels(const char* nombre) {
+    const KernelsOperaciones* candidato = kernelsPorNombre(nombre);
+    if (!candidato) return false;
+    kernelsSeleccionados.store(candidato, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,33 @@
+#ifndef OPERACIONES_SIMD_H
+#define OPERACIONES_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+// El digesto recorre la entrada en franjas de 32 bytes, una palabra de 64 bits por acumulador
+const int NUM_ACUMULADORES_DIGESTO = 4;
+const size_t BYTES_FRANJA_DIGESTO = NUM_ACUMULADORES_DIGESTO * 8;
+
+/**
+ * Nucleos por byte usados por operaciones.cpp. Cada variante (escalar, SSE2, AVX2,
+ * AVX-512) produce exactamente la misma salida; la que se usa se elige una sola vez
+ * segun la CPU. `destino` puede coincidir con la entrada (operacion en el lugar).
+ *
+ * `acumularDigesto` suma `numFranjas` franjas de BYTES_FRANJA_DIGESTO bytes a los
+ * acumuladores (ver `CalculoDigesto`); `primeraFranja` es la posicion de la primera
+ * dentro de toda la entrada, para que el digesto dependa del orden de las franjas. `contarDiferencias` devuelve cuantos bytes
+ * difieren y escribe en `primera` la posicion del primero (solo si hay alguno).
+ */
+struct KernelsOperaciones {
+    const char* nombre;
+    void (*xorBytes)(const unsigned char* a, const unsigned char* b, unsigned char* destino, size_t n);
+    void (*rotarIzquierdaBytes)(const unsigned char* img, unsigned char* destino, size_t n, int bits);
+    void (*sumarBytes)(const unsigned char* img, const unsigned char* mask, unsigned char* destino, size_t n);
+    void (*acumularDigesto)(uint64_t* acumuladores, const unsigned char* datos, size_t numFranjas, uint64_t primeraFranja);
+    size_t (*contarDiferencias)(const unsigned char* a, const unsigned char* b, size_t n, size_t* primera);
+};
+
+const KernelsOperaciones& KernelsActivos();
+bool SeleccionarKernels(const char* nombre);
+
+#endif // OPERACIONES_SIMD_H
@@ -0,0 +1,365 @@
+#include "planificacion.h"
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "memoria.h"
+#include "operaciones_paralelas.h"
+#include "operaciones_simd.h"
+#include "registro.h"
+#include "traza.h"
+#include "validacion.h"
+
+using namespace std;
+
+// Bytes procesados por bloque al aplicar una cadena: caben en la cache L2,
+// asi cada paso de la cadena relee datos que ya estan en cache.
+static const size_t BYTES_BLOQUE = 64 * 1024;
+
+// Agrega un paso al final de la cadena combinandolo con el anterior si es posible
+static int agregarPaso(PasoInverso* pasos, int numPasos, PasoInverso paso) {
+    if (numPasos > 0 && pasos[numPasos - 1].tipo == paso.tipo) {
+        if (paso.tipo == PASO_XOR) {
+            return numPasos - 1;
+        }
+        paso.bits = (pasos[numPasos - 1].bits + paso.bits) & 7;
+        numPasos--;
+    }
+
+    if (paso.tipo == PASO_ROTAR && paso.bits == 0) return numPasos;
+    pasos[numPasos++] = paso;
+    return numPasos;
+}
+
+/**
+ * @brief Convierte las operaciones detectadas en una cadena de pasos simplificada.
+ *
+ * Recorre las etapas de `desde` a `hasta` (ambas incluidas, en orden decreciente, que es el
+ * orden en que se aplican las inversas) y combina pasos consecutivos:
+ * - Rotaciones seguidas se suman en una sola rotacion izquierda modulo 8.
+ * - Dos XOR seguidos con IM se cancelan.
+ *
+ * @param operations Codigos de operacion por etapa (1, 2X o 3X).
+ * @param desde Primera etapa a aplicar (la de indice mayor).
+ * @param hasta Ultima etapa a aplicar.
+ * @param pasos Arreglo de salida con capacidad para `desde - hasta + 1` pasos.
+ * @return int Numero de pasos resultantes (0 si la cadena es la identidad).
+ */
+
+int CompilarCadenaInversa(const int* operations, int desde, int hasta, PasoInverso* pasos) {
+    int numPasos = 0;
+
+    for (int etapa = desde; etapa >= hasta; etapa--) {
+        int operacion = operations[etapa];
+        PasoInverso paso;
+        if (operacion == 1) {
+            paso.tipo = PASO_XOR;
+            paso.bits = 0;
+        } else if (operacion / 10 == 2) {
+            paso.tipo = PASO_ROTAR;
+            paso.bits = (operacion % 10) & 7;
+        } else {
+            paso.tipo = PASO_ROTAR;
+            paso.bits = (8 - operacion % 10) & 7;
+        }
+        numPasos = agregarPaso(pasos, numPasos, paso);
+    }
+
+    return numPasos;
+}
+
+/**
+ * @brief Convierte operaciones en la cadena que las aplica en sentido directo (enmascaramiento).
+ *
+ * Es la operacion contraria a `CompilarCadenaInversa`: recorre las etapas de `desde` a `hasta`
+ * en orden creciente y, para cada codigo, aplica la transformacion que la inversa deshace
+ * (XOR para 1, rotacion derecha de X bits para 2X e izquierda de X bits para 3X).
+ * Los pasos consecutivos se combinan igual que en la cadena inversa.
+ *
+ * @param operations Codigos de operacion por etapa (1, 2X o 3X), como los detecta la reconstruccion.
+ * @param desde Primera etapa a aplicar (la de indice menor).
+ * @param hasta Ultima etapa a aplicar.
+ * @param pasos Arreglo de salida con capacidad para `hasta - desde + 1` pasos.
+ * @return int Numero de pasos resultantes (0 si la cadena es la identidad).
+ */
+
+int CompilarCadenaDirecta(const int* operations, int desde, int hasta, PasoInverso* pasos) {
+    int numPasos = 0;
+
+    for (int etapa = desde; etapa <= hasta; etapa++) {
+        int operacion = operations[etapa];
+        PasoInverso paso;
+        if (operacion == 1) {
+            paso.tipo = PASO_XOR;
+            paso.bits = 0;
+        } else if (operacion / 10 == 2) {
+            paso.tipo = PASO_ROTAR;
+            paso.bits = (8 - operacion % 10) & 7;
+        } else {
+            paso.tipo = PASO_ROTAR;
+            paso.bits = (operacion % 10) & 7;
+        }
+        numPasos = agregarPaso(pasos, numPasos, paso);
+    }
+
+    return numPasos;
+}
+
+// Cuerpo de `AplicarCadenaInversa`, sin traza: tambien lo usa cada banda de la version paralela
+static void aplicarCadenaPorBloques(const unsigned char* origen, const unsigned char* IM, unsigned char* destino, size_t totalBytes, const PasoInverso* pasos, int numPasos) {
+    const KernelsOperaciones& kernels = KernelsActivos();
+
+    if (numPasos == 0) {
+        if (destino != origen) memmove(destino, origen, totalBytes);
+        return;
+    }
+
+    for (size_t inicio = 0; inicio < totalBytes; inicio += BYTES_BLOQUE) {
+        size_t n = totalBytes - inicio < BYTES_BLOQUE ? totalBytes - inicio : BYTES_BLOQUE;
+        const unsigned char* entrada = origen + inicio;
+        unsigned char* salida = destino + inicio;
+
+        for (int p = 0; p < numPasos; p++) {
+            if (pasos[p].tipo == PASO_XOR) {
+                kernels.xorBytes(entrada, IM + inicio, salida, n);
+            } else {
+                kernels.rotarIzquierdaBytes(entrada, salida, n, pasos[p].bits);
+            }
+            entrada = salida;
+        }
+    }
+}
+
+/**
+ * @brief Aplica una cadena de pasos inversos en una sola pasada por bloques.
+ *
+ * La imagen se recorre por bloques de `BYTES_BLOQUE`; a cada bloque se le aplican todos
+ * los pasos antes de pasar al siguiente, de modo que la memoria principal se lee y se
+ * escribe una sola vez sin importar el largo de la cadena.
+ *
+ * @param origen Bytes de entrada.
+ * @param IM Bytes de la imagen XOR alineados con `origen` (solo se lee si hay pasos XOR).
+ * @param destino Buffer de salida de `totalBytes` bytes (puede ser `origen`).
+ * @param totalBytes Numero de bytes a procesar.
+ * @param pasos Cadena compilada con `CompilarCadenaInversa` (o `CompilarCadenaDirecta`).
+ * @param numPasos Numero de pasos de la cadena.
+ */
+
+void AplicarCadenaInversa(const unsigned char* origen, const unsigned char* IM, unsigned char* destino, size_t totalBytes, const PasoInverso* pasos, int numPasos) {
+    AmbitoTraza traza("kernel", "AplicarCadenaInversa", (long long)totalBytes);
+    traza.argumento("pasos", numPasos);
+    aplicarCadenaPorBloques(origen, IM, destino, totalBytes, pasos, numPasos);
+}
+
+/**
+ * @brief Como `AplicarCadenaInversa`, repartiendo la imagen en bandas entre los hilos del pool.
+ *
+ * Cada banda se recorre por bloques igual que en la version de un hilo, por lo que el
+ * resultado es el mismo. Imagenes menores que `MIN_BYTES_PARALELO` se procesan en el
+ * hilo que llama.
+ *
+ * @see AplicarCadenaInversa, RepartirEnBandas
+ */
+
+void AplicarCadenaInversaParalela(const unsigned char* origen, const unsigned char* IM, unsigned char* destino, size_t totalBytes, const PasoInverso* pasos, int numPasos) {
+    AmbitoTraza traza("kernel", "AplicarCadenaInversaParalela", (long long)totalBytes);
+    traza.argumento("pasos", numPasos);
+
+    RepartirEnBandas(totalBytes, [&](size_t inicio, size_t n) {
+        aplicarCadenaPorBloques(origen + inicio, IM ? IM + inicio : nullptr, destino + inicio, n, pasos, numPasos);
+    });
+}
+
+// Estado compartido de la busqueda en profundidad de `PlanificarReconstruccion`
+struct BusquedaCadena {
+    const unsigned char* const* ventanasID;
+    const unsigned char* const* ventanasIM;
+    const int* longitudes;
+    const unsigned char* M;
+    const unsigned int* const* maskingData;
+    int numEtapas;
+    int* operations;
+    unsigned char* ventana;
+    PasoInverso* pasos;
+    // Clave: etapa y cadena compilada de las etapas posteriores
+    unordered_map<string, uint32_t> candidatosPorClave; // candidatos validos de la ventana
+    unordered_set<string> sinSolucion;                  // subarboles ya descartados
+    long long ventanasCalculadas = 0;
+    long long retrocesos = 0;
+    long long aciertosCache = 0;
+};
+
+// La ventana de una etapa depende solo de la cadena compilada de las inversas posteriores,
+// no del camino exacto: caminos equivalentes (por ejemplo izquierda 1 y derecha 7) comparten clave.
+static string claveEtapa(int etapa, const PasoInverso* pasos, int numPasos) {
+    string clave((const char*)&etapa, sizeof(etapa));
+    for (int i = 0; i < numPasos; i++) {
+        clave.push_back((char)(pasos[i].tipo * 8 + pasos[i].bits));
+    }
+    return clave;
+}
+
+static bool buscarDesdeEtapa(BusquedaCadena& busqueda, int etapa) {
+    if (etapa < 0) return true;
+
+    int numEtapas = busqueda.numEtapas;
+    int numPasos = CompilarCadenaInversa(busqueda.operations, numEtapas - 1, etapa + 1, busqueda.pasos);
+    string clave = claveEtapa(etapa, busqueda.pasos, numPasos);
+
+    if (busqueda.sinSolucion.count(clave)) {
+        busqueda.aciertosCache++;
+        return false;
+    }
+
+    uint32_t candidatos;
+    unordered_map<string, uint32_t>::iterator guardado = busqueda.candidatosPorClave.find(clave);
+    if (guardado != busqueda.candidatosPorClave.end()) {
+        busqueda.aciertosCache++;
+        candidatos = guardado->second;
+    } else {
+        // Ventana de la etapa: ID con las inversas de las etapas posteriores ya aplicadas
+        AmbitoMemoria fase(FASE_DETECCION, etapa);
+        int longitud = busqueda.longitudes[etapa];
+        AplicarCadenaInversaParalela(busqueda.ventanasID[etapa], busqueda.ventanasIM[etapa], busqueda.ventana, longitud, busqueda.pasos, numPasos);
+        busqueda.ventanasCalculadas++;
+        candidatos = CandidatosVentana(busqueda.ventana, busqueda.ventanasIM[etapa], busqueda.M, busqueda.maskingData[etapa], longitud);
+        busqueda.candidatosPorClave[clave] = candidatos;
+    }
+
+    // Los candidatos se prueban en orden de prioridad: la primera cadena completa es la
+    // lexicograficamente menor (de la ultima etapa a la primera)
+    for (int i = 0; i < NUM_CANDIDATOS; i++) {
+        if (!(candidatos & (1u << i))) continue;
+
+        busqueda.operations[etapa] = CodigoCandidato(i);
+        if (buscarDesdeEtapa(busqueda, etapa - 1)) return true;
+
+        busqueda.retrocesos++;
+        REGISTRO_DEPURACION << "Etapa " << (numEtapas - etapa) << "/" << numEtapas
+                            << ": el codigo " << CodigoCandidato(i) << " no lleva a una cadena valida\n";
+    }
+
+    busqueda.sinSolucion.insert(clave);
+    return false;
+}
+
+/**
+ * @brief Determina la operacion de todas las etapas trabajando solo sobre ventanas.
+ *
+ * Como todas las operaciones son byte a byte, la ventana de la semilla de una etapa se
+ * obtiene aplicando a la misma ventana de ID las inversas ya elegidas para las etapas
+ * posteriores. Asi se detecta cada etapa sin reconstruir la imagen completa; la imagen
+ * se reconstruye despues con `AplicarCadenaInversa` en una sola pasada.
+ *
+ * Con mascaras cortas una etapa puede coincidir con varios candidatos, y una eleccion
+ * equivocada solo se nota en una etapa anterior. Por eso la busqueda es en profundidad:
+ * se conservan todos los candidatos validos de cada etapa y, si una etapa posterior no
+ * tiene solucion, se vuelve atras y se prueba el siguiente. Los candidatos de cada
+ * ventana y los subarboles sin solucion se guardan por (etapa, cadena compilada), de
+ * modo que volver atras no recalcula ventanas. La cadena devuelta es la primera en
+ * orden de prioridad, la misma que elegia la deteccion etapa por etapa cuando esa
+ * eleccion lleva a una cadena completa.
+ *
+ * @param ID Imagen distorsionada original.
+ * @param IM Imagen utilizada para operaciones XOR.
+ * @param M Imagen de mascara.
+ * @param maskingData Arreglo doble con los datos de enmascaramiento por etapa.
+ * @param seeds Arreglo de semillas utilizadas en cada etapa.
+ * @param numEtapas Numero total de etapas.
+ * @param width Ancho de la imagen.
+ * @param height Alto de la imagen.
+ * @param mask_width Ancho de la mascara.
+ * @param mask_height Alto de la mascara.
+ * @param operations Arreglo de salida con la operacion detectada por etapa.
+ *
+ * @return true Si se encontro una cadena valida para todas las etapas.
+ * @return false Si ninguna combinacion de candidatos es valida.
+ *
+ * @see CandidatosVentana, CompilarCadenaInversa
+ */
+
+bool PlanificarReconstruccion(const unsigned char* ID, const unsigned char* IM, const unsigned char* M, const unsigned int* const* maskingData, const long long* seeds, int numEtapas, int width, int height, int mask_width, int mask_height, int* operations) {
+    AmbitoMemoria fase(FASE_DETECCION);
+    long long totalBytes = (long long)width * height * 3;
+    int maskSize = mask_width * mask_height * 3;
+
+    // Las ventanas apuntan directamente a ID e IM: no se copia nada
+    const unsigned char** ventanasID = new const unsigned char*[numEtapas > 0 ? numEtapas : 1];
+    const unsigned char** ventanasIM = new const unsigned char*[numEtapas > 0 ? numEtapas : 1];
+    int* longitudes = new int[numEtapas > 0 ? numEtapas : 1];
+    for (int etapa = 0; etapa < numEtapas; etapa++) {
+        long long semilla = seeds[etapa];
+        if (semilla < 0 || semilla > totalBytes) semilla = totalBytes;
+        long long disponible = totalBytes - semilla;
+        ventanasID[etapa] = ID + semilla;
+        ventanasIM[etapa] = IM + semilla;
+        longitudes[etapa] = disponible < maskSize ? (int)disponible : maskSize;
+    }
+
+    bool exito = PlanificarReconstruccionVentanas(ventanasID, ventanasIM, longitudes, M, maskingData, numEtapas, operations);
+
+    delete[] ventanasID;
+    delete[] ventanasIM;
+    delete[] longitudes;
+    return exito;
+}
+
+/**
+ * @brief Igual que `PlanificarReconstruccion`, pero recibe ya recortadas las ventanas de cada etapa.
+ *
+ * Permite planificar sin tener ID ni IM completos en memoria (por ejemplo, leyendo del
+ * archivo solo las filas que cubre cada semilla).
+ *
+ * @param ventanasID Bytes de ID a partir de la semilla de cada etapa.
+ * @param ventanasIM Bytes de IM a partir de la semilla de cada etapa.
+ * @param longitudes Bytes de cada ventana (la mascara recortada al final de la imagen).
+ * @param M Imagen de mascara.
+ * @param maskingData Datos de enmascaramiento por etapa.
+ * @param numEtapas Numero de etapas.
+ * @param operations Arreglo de salida con la operacion detectada por etapa.
+ *
+ * @return true Si se encontro una cadena valida para todas las etapas.
+ */
+
+bool PlanificarReconstruccionVentanas(const unsigned char* const* ventanasID, const unsigned char* const* ventanasIM, const int* longitudes, const unsigned char* M, const unsigned int* const* maskingData, int numEtapas, int* operations) {
+    AmbitoTraza traza("etapa", "PlanificarReconstruccion");
+    traza.argumento("etapas", numEtapas);
+    AmbitoMemoria fase(FASE_DETECCION);
+
+    int maxLongitud = 1;
+    for (int etapa = 0; etapa < numEtapas; etapa++) {
+        if (longitudes[etapa] > maxLongitud) maxLongitud = longitudes[etapa];
+    }
+
+    BusquedaCadena busqueda;
+    busqueda.ventanasID = ventanasID;
+    busqueda.ventanasIM = ventanasIM;
+    busqueda.longitudes = longitudes;
+    busqueda.M = M;
+    busqueda.maskingData = maskingData;
+    busqueda.numEtapas = numEtapas;
+    busqueda.operations = operations;
+    busqueda.ventana = new unsigned char[maxLongitud];
+    busqueda.pasos = new PasoInverso[numEtapas > 0 ? numEtapas : 1];
+
+    salida() << "\nPLANIFICANDO RECONSTRUCCION (" << numEtapas << " etapas)\n";
+
+    bool exito = buscarDesdeEtapa(busqueda, numEtapas - 1);
+    if (exito) {
+        for (int etapa = numEtapas - 1; etapa >= 0; etapa--) {
+            salida() << "Etapa " << (numEtapas - etapa) << "/" << numEtapas
+                 << ": operacion detectada (codigo " << operations[etapa] << ")\n";
+        }
+    } else {
+        salidaError() << "No hay ninguna combinacion de operaciones valida para todas las etapas\n";
+    }
+    salida() << "Busqueda: " << busqueda.ventanasCalculadas << " ventanas, " << busqueda.retrocesos
+             << " retrocesos, " << busqueda.aciertosCache << " aciertos de cache\n";
+    traza.argumento("retrocesos", busqueda.retrocesos);
+
+    delete[] busqueda.ventana;
+    delete[] busqueda.pasos;
+    return exito;
+}
@@ -0,0 +1,22 @@
+#ifndef PLANIFICACION_H
+#define PLANIFICACION_H
+
+#include <cstddef>
+
+// Tipos de paso de una cadena inversa compilada
+const int PASO_XOR = 1;
+const int PASO_ROTAR = 2; // rotacion izquierda de `bits` bits (1 a 7)
+
+struct PasoInverso {
+    int tipo;
+    int bits;
+};
+
+int CompilarCadenaInversa(const int* operations, int desde, int hasta, PasoInverso* pasos);
+int CompilarCadenaDirecta(const int* operations, int desde, int hasta, PasoInverso* pasos);
+void AplicarCadenaInversa(const unsigned char* origen, const unsigned char* IM, unsigned char* destino, size_t totalBytes, const PasoInverso* pasos, int numPasos);
+void AplicarCadenaInversaParalela(const unsigned char* origen, const unsigned char* IM, unsigned char* destino, size_t totalBytes, const PasoInverso* pasos, int numPasos);
+bool PlanificarReconstruccion(const unsigned char* ID, const unsigned char* IM, const unsigned char* M, const unsigned int* const* maskingData, const long long* seeds, int numEtapas, int width, int height, int mask_width, int mask_height, int* operations);
+bool PlanificarReconstruccionVentanas(const unsigned char* const* ventanasID, const unsigned char* const* ventanasIM, const int* longitudes, const unsigned char* M, const unsigned int* const* maskingData, int numEtapas, int* operations);
+
+#endif // PLANIFICACION_H
@@ -1,83 +1,228 @@
 #include "procesamiento.h"
 #include <QImage>
-#include <fstream>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtEndian>
+#include <charconv>
+#include <cstring>
 #include <iostream>
+#include <vector>
 
+#include "bmp.h"
+#include "recursos.h"
+#include "registro.h"
+#include "traza.h"
 #include "validacion.h"
 
 using namespace std;
 
-unsigned char* loadPixels(const QString& input, int& width, int& height) {
+// Decodifica `input` en formato interno. El buffer lo reserva `reservar` una vez conocidas
+// las dimensiones; devuelve nullptr si la imagen no se pudo cargar.
+template <class Reservar>
+static unsigned char* decodificarPixeles(const QString& input, int& width, int& height, Reservar reservar) {
+    AmbitoTraza traza("carga", "loadPixels");
+
+    // BMP de 24 bits: se lee directamente del archivo mapeado, sin pasar por QImage
+    QFile archivo;
+    VistaBMP vista;
+    if (AbrirBMP(input, archivo, vista)) {
+        width = vista.ancho;
+        height = vista.alto;
+        unsigned char* pixelData = reservar(width, height);
+        CopiarBMPaRGB(vista, pixelData);
+        traza.argumento("bytes", (long long)width * height * 3);
+        return pixelData;
+    }
+
     QImage imagen(input);
     if (imagen.isNull()) {
-        std::cout << "Error: No se pudo cargar la imagen." << std::endl;
+        salidaError() << "Error: No se pudo cargar la imagen " << input.toStdString() << '\n';
         return nullptr;
     }
 
     imagen = imagen.convertToFormat(QImage::Format_RGB888);
     width = imagen.width();
     height = imagen.height();
-    int dataSize = width * height * 3;
+    size_t dataSize = (size_t)width * height * 3;
 
-    unsigned char* pixelData = new unsigned char[dataSize];
+    unsigned char* pixelData = reservar(width, height);
     for (int y = 0; y < height; ++y) {
-        memcpy(pixelData + y * width * 3, imagen.scanLine(y), width * 3);
+        memcpy(pixelData + (size_t)y * width * 3, imagen.scanLine(y), (size_t)width * 3);
     }
 
+    traza.argumento("bytes", (long long)dataSize);
     return pixelData;
 }
 
-bool exportImage(unsigned char* pixelData, int width, int height, const QString& archivoSalida) {
+unsigned char* loadPixels(const QString& input, int& width, int& height) {
+    return decodificarPixeles(input, width, height, [](int w, int h) {
+        return new unsigned char[(size_t)w * h * 3];
+    });
+}
+
+/**
+ * @brief Como `loadPixels`, pero decodifica en una `Imagen` (buffer alineado).
+ *
+ * @return false Si la imagen no se pudo cargar (`imagen` queda vacia).
+ */
+bool CargarImagen(const QString& input, Imagen& imagen) {
+    int width = 0, height = 0;
+    unsigned char* pixeles = decodificarPixeles(input, width, height, [&](int w, int h) {
+        imagen = Imagen(w, h);
+        return imagen.datos();
+    });
+    if (!pixeles) imagen = Imagen();
+    return pixeles != nullptr;
+}
+
+bool exportImage(const unsigned char* pixelData, int width, int height, const QString& archivoSalida) {
+    AmbitoTraza traza("exportacion", "exportImage", (long long)width * height * 3);
+
+    if (EscribirBMP(pixelData, width, height, archivoSalida)) {
+        return true;
+    }
+
     QImage outputImage(width, height, QImage::Format_RGB888);
 
     for (int y = 0; y < height; ++y) {
-        memcpy(outputImage.scanLine(y), pixelData + y * width * 3, width * 3);
+        memcpy(outputImage.scanLine(y), pixelData + (size_t)y * width * 3, (size_t)width * 3);
     }
 
     if (!outputImage.save(archivoSalida, "BMP")) {
-        std::cout << "Error: No se pudo guardar la imagen BMP." << std::endl;
+        salidaError() << "Error: No se pudo guardar la imagen BMP " << archivoSalida.toStdString() << '\n';
         return false;
     }
     return true;
 }
 
-unsigned int* loadSeedMasking(const char* nombreArchivo, int& seed, int& n_pixels) {
-    std::ifstream archivo(nombreArchivo);
-    if (!archivo.is_open()) {
-        std::cout << "No se pudo abrir el archivo." << std::endl;
-        return nullptr;
+// Archivo binario compacto junto a cada M*.txt: "DSM2", semilla (int64),
+// numero de pixeles (int32) y luego los valores empaquetados en uint16 little-endian.
+// Los "DSM1" (semilla int32) no se reconocen y se regeneran desde el texto.
+static const char MAGIA_SIDECAR[4] = {'D', 'S', 'M', '2'};
+static const qint64 CABECERA_SIDECAR = 16;
+
+static QString rutaSidecar(const QString& archivoTexto) {
+    return archivoTexto + ".bin";
+}
+
+static unsigned int* cargarSidecarMascara(const QString& ruta, long long& seed, int& n_pixels) {
+    QFile archivo(ruta);
+    if (!archivo.open(QIODevice::ReadOnly)) return nullptr;
+
+    qint64 tam = archivo.size();
+    if (tam < CABECERA_SIDECAR) return nullptr;
+
+    uchar* datos = archivo.map(0, tam);
+    if (!datos || memcmp(datos, MAGIA_SIDECAR, 4) != 0) return nullptr;
+
+    long long semillaLeida = qFromLittleEndian<qint64>(datos + 4);
+    int pixelesLeidos = qFromLittleEndian<qint32>(datos + 12);
+    if (pixelesLeidos < 0 || tam != CABECERA_SIDECAR + (qint64)pixelesLeidos * 3 * 2) return nullptr;
+
+    unsigned int* RGB = new unsigned int[(size_t)pixelesLeidos * 3];
+    const uchar* valores = datos + CABECERA_SIDECAR;
+    for (size_t i = 0; i < (size_t)pixelesLeidos * 3; i++) {
+        RGB[i] = qFromLittleEndian<quint16>(valores + 2 * i);
     }
 
-    archivo >> seed;
-    n_pixels = 0;
-    int r, g, b;
+    seed = semillaLeida;
+    n_pixels = pixelesLeidos;
+    return RGB;
+}
+
+static void guardarSidecarMascara(const QString& ruta, long long seed, int n_pixels, const unsigned int* RGB) {
+    size_t total = (size_t)n_pixels * 3;
+    for (size_t i = 0; i < total; i++) {
+        if (RGB[i] > 0xFFFF) return; // no cabe en el formato empaquetado
+    }
 
-    // Primera pasada para contar los píxeles
-    while (archivo >> r >> g >> b) {
-        n_pixels++;
+    std::vector<uchar> buffer(CABECERA_SIDECAR + total * 2);
+    memcpy(buffer.data(), MAGIA_SIDECAR, 4);
+    qToLittleEndian<qint64>(seed, buffer.data() + 4);
+    qToLittleEndian<qint32>(n_pixels, buffer.data() + 12);
+    for (size_t i = 0; i < total; i++) {
+        qToLittleEndian<quint16>((quint16)RGB[i], buffer.data() + CABECERA_SIDECAR + 2 * i);
     }
 
-    archivo.close();
-    archivo.open(nombreArchivo);
+    QSaveFile archivo(ruta);
+    if (!archivo.open(QIODevice::WriteOnly)) return;
+    archivo.write((const char*)buffer.data(), (qint64)buffer.size());
+    archivo.commit();
+}
 
-    if (!archivo.is_open()) {
-        std::cout << "Error al reabrir el archivo." << std::endl;
+// Lee la semilla y los valores RGB en una sola pasada sobre el archivo mapeado en memoria.
+static unsigned int* parsearTextoMascara(const QString& ruta, long long& seed, int& n_pixels) {
+    QFile archivo(ruta);
+    if (!archivo.open(QIODevice::ReadOnly)) {
+        salidaError() << "No se pudo abrir el archivo " << ruta.toStdString() << '\n';
         return nullptr;
     }
 
-    unsigned int* RGB = new unsigned int[n_pixels * 3];
-    archivo >> seed;
+    qint64 tam = archivo.size();
+    QByteArray copia;
+    const char* inicio = nullptr;
+    if (tam > 0) inicio = (const char*)archivo.map(0, tam);
+    if (!inicio) {
+        copia = archivo.readAll();
+        inicio = copia.constData();
+        tam = copia.size();
+    }
+    const char* fin = inicio + tam;
+
+    auto saltarEspacios = [&](const char* p) {
+        while (p < fin && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++;
+        return p;
+    };
 
-    for (int i = 0; i < n_pixels * 3; i += 3) {
-        archivo >> r >> g >> b;
-        RGB[i] = r;
-        RGB[i + 1] = g;
-        RGB[i + 2] = b;
+    const char* p = saltarEspacios(inicio);
+    std::from_chars_result r = std::from_chars(p, fin, seed);
+    if (r.ec != std::errc()) {
+        salidaError() << "Error: archivo de enmascaramiento sin semilla: " << ruta.toStdString() << '\n';
+        return nullptr;
     }
+    p = r.ptr;
 
-    archivo.close();
-    std::cout << "Semilla: " << seed << std::endl;
-    std::cout << "Cantidad de pixeles leidos: " << n_pixels << std::endl;
+    // Cada valor ocupa al menos dos caracteres (digito y separador)
+    std::vector<unsigned int> valores;
+    valores.reserve((size_t)(fin - p) / 2 + 1);
+    while (true) {
+        p = saltarEspacios(p);
+        int valor;
+        r = std::from_chars(p, fin, valor);
+        if (r.ec != std::errc()) break;
+        valores.push_back((unsigned int)valor);
+        p = r.ptr;
+    }
+
+    // Igual que antes, solo se cuentan tripletas completas
+    n_pixels = (int)(valores.size() / 3);
+    unsigned int* RGB = new unsigned int[(size_t)n_pixels * 3];
+    memcpy(RGB, valores.data(), (size_t)n_pixels * 3 * sizeof(unsigned int));
+    return RGB;
+}
+
+unsigned int* loadSeedMasking(const char* nombreArchivo, long long& seed, int& n_pixels) {
+    AmbitoTraza traza("carga", "loadSeedMasking");
+    QString ruta = QString::fromLocal8Bit(nombreArchivo);
+    QString sidecar = rutaSidecar(ruta);
+    QFileInfo infoTexto(ruta);
+    QFileInfo infoSidecar(sidecar);
+
+    unsigned int* RGB = nullptr;
+    if (infoSidecar.exists() && (!infoTexto.exists() || infoSidecar.lastModified() > infoTexto.lastModified())) {
+        RGB = cargarSidecarMascara(sidecar, seed, n_pixels);
+    }
+
+    if (!RGB) {
+        RGB = parsearTextoMascara(ruta, seed, n_pixels);
+        if (!RGB) return nullptr;
+        guardarSidecarMascara(sidecar, seed, n_pixels, RGB);
+    }
+    traza.argumento("bytes", (long long)n_pixels * 3 * sizeof(unsigned int));
+
+    REGISTRO_DEPURACION << "Semilla: " << seed << '\n'
+                        << "Cantidad de pixeles leidos: " << n_pixels << '\n';
 
     return RGB;
 }
@@ -85,78 +230,68 @@ unsigned int* loadSeedMasking(const char* nombreArchivo, int& seed, int& n_pixel
 void printOperationDescription(int operationCode) {
     switch (operationCode / 10) {
     case 0:
-        cout << "XOR con I_M";
+        salida() << "XOR con I_M";
         break;
     case 2:
-        cout << "Rotacion derecha (" << (operationCode%10) << " bits)";
+        salida() << "Rotacion derecha (" << (operationCode%10) << " bits)";
         break;
     case 3:
-        cout << "Rotacion izquierda (" << (operationCode%10) << " bits)";
+        salida() << "Rotacion izquierda (" << (operationCode%10) << " bits)";
         break;
     default:
-        cout << "Operacion desconocida (Codigo: " << operationCode << ")";
+        salida() << "Operacion desconocida (Codigo: " << operationCode << ")";
     }
 }
 
-bool crearCopiaValidada(const QString& rutaBase) {
-    // 1. Cargar imagen original I_O.bmp
-    int width, height;
-    QString originalPath = rutaBase + "I_O.bmp";
-    unsigned char* IO = loadPixels(originalPath, width, height);
-
-    if (!IO) {
-        cerr << "Error: No se pudo cargar I_O.bmp" << endl;
-        return false;
-    }
-
-    // 2. Cargar máscara M0.txt
-    QString maskPath = rutaBase + "M0.txt";
-    int seed, numPixels;
-    unsigned int* maskData = loadSeedMasking(maskPath.toStdString().c_str(), seed, numPixels);
+/**
+ * @brief Verifica en memoria la imagen reconstruida, sin escribirla ni volver a leerla.
+ *
+ * Calcula el digesto de la reconstruccion y, si el caso tiene I_O.bmp, el de la original
+ * y la comparacion byte a byte (primer byte distinto y cuantos difieren). Si hay M0.txt
+ * tambien valida la reconstruccion con M0.txt y M.bmp. I_O.bmp, M0.txt y M.bmp se piden
+ * al almacen de recursos, asi M.bmp no se vuelve a decodificar si el caso sigue cargado.
+ *
+ * @param rutaBase Directorio del caso (terminado en '/').
+ * @param reconstruida Imagen reconstruida (vista contigua).
+ * @param resultado Digestos y comparacion, para el resumen del caso.
+ *
+ * @return false Si la reconstruccion difiere de I_O.bmp o no cumple M0.txt.
+ *
+ * @see CalculoDigesto, CompararBytes
+ */
+bool VerificarReconstruccion(const QString& rutaBase, const VistaLectura& reconstruida, VerificacionReconstruccion& resultado) {
+    AmbitoTraza traza("etapa", "VerificarReconstruccion", (long long)reconstruida.bytes());
+    AlmacenRecursos& almacen = AlmacenRecursos::global();
+    resultado = VerificacionReconstruccion();
+    if (!reconstruida.contigua()) return false;
 
-    if (!maskData) {
-        cerr << "Error: No se pudo cargar M0.txt" << endl;
-        delete[] IO;
-        return false;
-    }
+    resultado.totalBytes = (long long)reconstruida.bytes();
+    resultado.digestoReconstruida = DigestoBytes(reconstruida.datos, reconstruida.bytes());
 
-    // 3. Cargar imagen de máscara M.bmp
-    int mask_width, mask_height;
-    QString maskImgPath = rutaBase + "M.bmp";
-    unsigned char* M = loadPixels(maskImgPath, mask_width, mask_height);
-
-    if (!M) {
-        cerr << "Error: No se pudo cargar M.bmp" << endl;
-        delete[] IO;
-        delete[] maskData;
-        return false;
+    // 1. Comparar con la original, si el caso la tiene
+    QString rutaOriginal = rutaBase + "I_O.bmp";
+    shared_ptr<const Imagen> IO = QFileInfo::exists(rutaOriginal) ? almacen.imagen(rutaOriginal) : nullptr;
+    if (IO) {
+        resultado.hayOriginal = true;
+        resultado.digestoOriginal = DigestoBytes(IO->datos(), IO->bytes());
+        if (IO->ancho() != reconstruida.ancho || IO->alto() != reconstruida.alto) {
+            salidaError() << "Error: I_O.bmp no tiene las dimensiones de la imagen reconstruida\n";
+            resultado.primeraDiferencia = 0;
+            resultado.bytesDistintos = resultado.totalBytes;
+        } else {
+            CompararBytes(reconstruida.datos, IO->datos(), IO->bytes(), 0, resultado);
+        }
     }
 
-    // 4. Validar la suma de la máscara
-    if (!ValidarSumaMascara(IO, M, maskData, seed, width, height, mask_width, mask_height)) {
-        cerr << "Error: Validación de máscara fallida" << endl;
-        delete[] IO;
-        delete[] maskData;
-        delete[] M;
-        return false;
+    // 2. Validar la reconstruccion con los datos de enmascaramiento de la etapa 0
+    QString rutaM0 = rutaBase + "M0.txt";
+    if (QFileInfo::exists(rutaM0)) {
+        shared_ptr<const MascaraCargada> maskData = almacen.mascara(rutaM0);
+        shared_ptr<const Imagen> M = almacen.imagen(rutaBase + "M.bmp");
+        bool valida = maskData && M && ValidarSumaMascara(reconstruida, M->vista(), maskData->datos, maskData->semilla);
+        resultado.validacionM0 = valida ? 1 : 0;
     }
 
-    // 5. Crear copia validada
-    QString copyPath = rutaBase + "I_OReconstruida.bmp";
-    if (!exportImage(IO, width, height, copyPath)) {
-        cerr << "Error: No se pudo guardar la copia" << endl;
-        delete[] IO;
-        delete[] maskData;
-        delete[] M;
-        return false;
-    }
-
-    //cout << "Copia validada creada exitosamente: " << copyPath.toStdString() << endl;
-
-    // 6. Liberar memoria
-    delete[] IO;
-    delete[] maskData;
-    delete[] M;
-
-    return true;
+    traza.argumento("bytes_distintos", resultado.bytesDistintos);
+    return resultado.correcta();
 }
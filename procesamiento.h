@@ -3,10 +3,15 @@
 
 #include <QString>
 
+#include "imagen.h"
+
+struct VerificacionReconstruccion;
+
 unsigned char* loadPixels(const QString& input, int& width, int& height);
-bool exportImage(unsigned char* pixelData, int width, int height, const QString& archivoSalida);
-unsigned int* loadSeedMasking(const char* nombreArchivo, int& seed, int& n_pixels);
+bool CargarImagen(const QString& input, Imagen& imagen);
+bool exportImage(const unsigned char* pixelData, int width, int height, const QString& archivoSalida);
+unsigned int* loadSeedMasking(const char* nombreArchivo, long long& seed, int& n_pixels);
 void printOperationDescription(int operationCode);
-bool crearCopiaValidada(const QString& rutaBase);
+bool VerificarReconstruccion(const QString& rutaBase, const VistaLectura& reconstruida, VerificacionReconstruccion& resultado);
 
 #endif // PROCESAMIENTO_H
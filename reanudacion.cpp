@@ -0,0 +1,192 @@
+#include "reanudacion.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <QFile>
+#include <QSaveFile>
+
+#include "hilos.h"
+#include "traza.h"
+#include "validacion.h"
+
+using namespace std;
+
+/**
+ * @brief Digesto del contenido de un archivo tal como esta en disco (sin decodificarlo).
+ */
+static bool digestoArchivo(const QString& ruta, uint64_t& digesto) {
+    QFile archivo(ruta);
+    if (!archivo.open(QIODevice::ReadOnly)) return false;
+
+    qint64 tamano = archivo.size();
+    if (tamano == 0) {
+        digesto = DigestoBytes(nullptr, 0);
+        return true;
+    }
+    uchar* datos = archivo.map(0, tamano);
+    if (!datos) return false;
+    digesto = DigestoBytes(datos, (size_t)tamano);
+    archivo.unmap(datos);
+    return true;
+}
+
+static bool operacionValida(int operacion) {
+    for (int i = 0; i < NUM_CANDIDATOS; i++) {
+        if (CodigoCandidato(i) == operacion) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Calcula los digestos de las entradas del caso y lee las etapas ya guardadas.
+ *
+ * Cada entrada (I_D.bmp, I_M.bmp, M.bmp y los M*.txt) se lee en su propia tarea del
+ * pool. Del archivo de puntos de control se conservan, en orden, las etapas cuyo digesto
+ * de entradas coincide con el de los archivos actuales; la primera que no coincide y
+ * todas las que la siguen se descartan.
+ *
+ * @param rutaBase Directorio del caso (terminado en '/').
+ * @param numEtapas Numero de archivos M*.txt del caso.
+ * @param reanudar false: ignorar las etapas guardadas (se empieza desde I_D.bmp).
+ *
+ * @return false Si no se pudo leer alguna entrada; el caso se procesa sin puntos de control.
+ */
+bool PuntosControl::abrir(const QString& rutaBase, int numEtapas, bool reanudar) {
+    AmbitoTraza traza("carga", "PuntosControl::abrir");
+    this->rutaBase = rutaBase;
+    this->numEtapas = numEtapas;
+    etapas.clear();
+
+    vector<QString> archivos = { "I_D.bmp", "I_M.bmp", "M.bmp" };
+    for (int i = 0; i < numEtapas; i++) {
+        archivos.push_back(QString("M%1.txt").arg(i+1));
+    }
+    vector<uint64_t> digestos(archivos.size());
+    vector<char> leidos(archivos.size());
+
+    PoolHilos& pool = PoolHilos::global();
+    GrupoTareas lectura;
+    for (size_t i = 0; i < archivos.size(); i++) {
+        pool.encolar(lectura, [&, i] { leidos[i] = digestoArchivo(rutaBase + archivos[i], digestos[i]); });
+    }
+    pool.esperar(lectura);
+
+    for (char leido : leidos) {
+        if (!leido) return false;
+    }
+    uint64_t base[4] = { (uint64_t)numEtapas, digestos[0], digestos[1], digestos[2] };
+    digestoBase = DigestoBytes((const unsigned char*)base, sizeof(base));
+    digestosMascaras.assign(digestos.begin() + 3, digestos.end());
+
+    if (!reanudar) return true;
+
+    QFile archivo(rutaBase + ARCHIVO_PUNTOS_CONTROL);
+    if (!archivo.open(QIODevice::ReadOnly)) return true;
+    QByteArray contenido = archivo.readAll();
+    istringstream lineas(string(contenido.constData(), (size_t)contenido.size()));
+
+    // Formato: cabecera "etapas N" y "base DIGESTO", luego una linea por etapa aplicada
+    bool etapasCoinciden = false, baseCoincide = false;
+    string linea;
+    while (getline(lineas, linea)) {
+        if (linea.empty() || linea[0] == '#' || linea[0] == '\r') continue;
+
+        istringstream campos(linea);
+        string clave;
+        campos >> clave;
+        if (clave == "etapas") {
+            int n = -1;
+            campos >> n;
+            etapasCoinciden = (n == numEtapas);
+        } else if (clave == "base") {
+            uint64_t digesto = 0;
+            campos >> hex >> digesto;
+            baseCoincide = !campos.fail() && digesto == digestoBase;
+        } else if (clave == "etapa") {
+            if (!etapasCoinciden || !baseCoincide || (int)etapas.size() == numEtapas) break;
+
+            EtapaCompletada guardada;
+            string etiquetaOperacion, etiquetaEntradas, etiquetaImagen, etiquetaDigesto, imagen;
+            campos >> guardada.etapa >> etiquetaOperacion >> guardada.operacion
+                   >> etiquetaEntradas >> hex >> guardada.digestoEntradas >> dec
+                   >> etiquetaImagen >> imagen >> etiquetaDigesto >> hex >> guardada.digestoImagen;
+            if (campos.fail() || guardada.etapa != numEtapas - 1 - (int)etapas.size() || !operacionValida(guardada.operacion)) break;
+            if (guardada.digestoEntradas != digestoEntradas(guardada.etapa)) break;
+
+            guardada.imagen = QString::fromStdString(imagen);
+            etapas.push_back(guardada);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Se queda con las primeras `numEtapasValidas` etapas guardadas.
+ *
+ * La siguiente llamada a `registrar` reescribe el archivo sin las descartadas.
+ */
+void PuntosControl::conservar(size_t numEtapasValidas) {
+    if (numEtapasValidas < etapas.size()) etapas.resize(numEtapasValidas);
+}
+
+/**
+ * @brief Guarda una etapa recien aplicada y reescribe el archivo de puntos de control.
+ *
+ * Las etapas se registran en el orden en que se aplican (de numEtapas-1 a 0). La imagen
+ * se exporta en segundo plano y puede no estar escrita todavia; por eso se guarda su
+ * digesto y quien reanuda lo comprueba antes de usarla.
+ *
+ * @param etapa Indice de la etapa aplicada.
+ * @param operacion Codigo de la operacion detectada.
+ * @param imagen Archivo con la imagen que deja la etapa, relativo al caso.
+ * @param pixeles Esa misma imagen en memoria (RGB contiguo).
+ * @param bytes Tamano de la imagen en bytes.
+ *
+ * @return false Si la etapa no es la siguiente esperada o no se pudo escribir el archivo.
+ */
+bool PuntosControl::registrar(int etapa, int operacion, const QString& imagen, const unsigned char* pixeles, size_t bytes) {
+    AmbitoTraza traza("etapa", "PuntosControl::registrar", (long long)bytes);
+    if (etapa != numEtapas - 1 - (int)etapas.size()) return false;
+
+    EtapaCompletada completada;
+    completada.etapa = etapa;
+    completada.operacion = operacion;
+    completada.digestoEntradas = digestoEntradas(etapa);
+    completada.imagen = imagen;
+    completada.digestoImagen = DigestoBytes(pixeles, bytes);
+    etapas.push_back(completada);
+    return guardar();
+}
+
+// Digesto de la imagen de entrada de la etapa (base, mascaras y operaciones de las
+// etapas anteriores ya guardadas) mas el M*.txt de la propia etapa.
+uint64_t PuntosControl::digestoEntradas(int etapa) const {
+    uint64_t valores[3];
+    if (etapas.empty()) {
+        valores[0] = digestoBase;
+        valores[1] = 0;
+    } else {
+        valores[0] = etapas.back().digestoEntradas;
+        valores[1] = (uint64_t)etapas.back().operacion;
+    }
+    valores[2] = digestosMascaras[etapa];
+    return DigestoBytes((const unsigned char*)valores, sizeof(valores));
+}
+
+bool PuntosControl::guardar() const {
+    string texto = "# Puntos de control de la reconstruccion (se reescribe tras cada etapa)\n";
+    char linea[256];
+    snprintf(linea, sizeof(linea), "etapas %d\nbase %016llx\n", numEtapas, (unsigned long long)digestoBase);
+    texto += linea;
+    for (const EtapaCompletada& guardada : etapas) {
+        snprintf(linea, sizeof(linea), "etapa %d operacion %d entradas %016llx imagen %s digesto %016llx\n",
+                 guardada.etapa, guardada.operacion, (unsigned long long)guardada.digestoEntradas,
+                 guardada.imagen.toStdString().c_str(), (unsigned long long)guardada.digestoImagen);
+        texto += linea;
+    }
+
+    QSaveFile archivo(rutaBase + ARCHIVO_PUNTOS_CONTROL);
+    if (!archivo.open(QIODevice::WriteOnly)) return false;
+    archivo.write(texto.data(), (qint64)texto.size());
+    return archivo.commit();
+}
@@ -0,0 +1,53 @@
+#ifndef REANUDACION_H
+#define REANUDACION_H
+
+#include <QString>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Archivo de puntos de control dentro del directorio de cada caso
+const char* const ARCHIVO_PUNTOS_CONTROL = "reanudacion.txt";
+
+// Una etapa ya aplicada, tal como se guarda en el archivo de puntos de control
+struct EtapaCompletada {
+    int etapa = 0;                 // indice de la etapa (usa M(etapa+1).txt)
+    int operacion = 0;             // codigo detectado (1, 2X o 3X)
+    uint64_t digestoEntradas = 0;  // digesto encadenado de todo lo que uso la etapa
+    QString imagen;                // imagen que dejo la etapa, relativa al caso
+    uint64_t digestoImagen = 0;    // digesto de los pixeles de esa imagen
+};
+
+/**
+ * Puntos de control de una reconstruccion por etapas.
+ *
+ * Tras cada etapa se reescribe `reanudacion.txt` con la operacion detectada, un digesto
+ * de las entradas de la etapa y la imagen intermedia que dejo (P*_reconstruida.bmp). El
+ * digesto de entradas encadena el de I_D.bmp, I_M.bmp y M.bmp, el de los M*.txt usados
+ * hasta esa etapa y las operaciones anteriores, asi cambiar cualquier archivo invalida
+ * esa etapa y todas las siguientes.
+ *
+ * `abrir` conserva solo las etapas guardadas cuyo digesto coincide con los archivos
+ * actuales; el llamador carga la imagen de la ultima, comprueba `digestoImagen` y
+ * continua desde ahi con `conservar`.
+ */
+class PuntosControl {
+public:
+    bool abrir(const QString& rutaBase, int numEtapas, bool reanudar);
+
+    const std::vector<EtapaCompletada>& etapasGuardadas() const { return etapas; }
+    void conservar(size_t numEtapasValidas);
+    bool registrar(int etapa, int operacion, const QString& imagen, const unsigned char* pixeles, size_t bytes);
+
+private:
+    uint64_t digestoEntradas(int etapa) const;
+    bool guardar() const;
+
+    QString rutaBase;
+    int numEtapas = 0;
+    uint64_t digestoBase = 0;                // I_D.bmp, I_M.bmp, M.bmp y numero de etapas
+    std::vector<uint64_t> digestosMascaras;  // M(i+1).txt para cada etapa i
+    std::vector<EtapaCompletada> etapas;     // desde la etapa numEtapas-1 hacia la 0
+};
+
+#endif // REANUDACION_H
@@ -0,0 +1,183 @@
+#include "recursos.h"
+#include <QDateTime>
+#include <QFileInfo>
+
+#include "procesamiento.h"
+
+using namespace std;
+
+AlmacenRecursos& AlmacenRecursos::global() {
+    static AlmacenRecursos almacen;
+    return almacen;
+}
+
+static shared_ptr<const Imagen> cargarImagen(const QString& ruta) {
+    shared_ptr<Imagen> imagen = make_shared<Imagen>();
+    if (!CargarImagen(ruta, *imagen)) return nullptr;
+    return imagen;
+}
+
+static shared_ptr<const MascaraCargada> cargarMascara(const QString& ruta) {
+    shared_ptr<MascaraCargada> mascara = make_shared<MascaraCargada>();
+    mascara->datos = loadSeedMasking(ruta.toStdString().c_str(), mascara->semilla, mascara->numPixeles);
+    if (!mascara->datos) return nullptr;
+    return mascara;
+}
+
+static size_t bytesRecurso(const Imagen& imagen) {
+    return imagen.bytes();
+}
+
+static size_t bytesRecurso(const MascaraCargada& mascara) {
+    return (size_t)mascara.numPixeles * 3 * sizeof(unsigned int);
+}
+
+// Prefijo de la clave en la cache LRU, que guarda imagenes y mascaras juntas
+static const char* prefijoCache(const Imagen*) {
+    return "imagen:";
+}
+
+static const char* prefijoCache(const MascaraCargada*) {
+    return "mascara:";
+}
+
+template <class T>
+shared_ptr<const T> AlmacenRecursos::obtener(unordered_map<string, shared_ptr<Entrada<T>>>& mapa,
+                                             const QString& ruta, shared_ptr<const T> (*cargar)(const QString&)) {
+    string clave = ruta.toStdString();
+    string claveCache = prefijoCache((const T*)nullptr) + clave;
+    shared_ptr<Entrada<T>> entrada;
+    {
+        lock_guard<mutex> lock(cerrojo);
+        shared_ptr<Entrada<T>>& encontrada = mapa[clave];
+        if (!encontrada) encontrada = make_shared<Entrada<T>>();
+        entrada = encontrada;
+
+        // En una ejecucion larga (servidor) no se acumulan entradas de archivos ya liberados
+        size_t entradas = imagenes.size() + mascaras.size();
+        if (entradas > 2 * entradasTrasPurga + 256) {
+            purgarCaducadas(imagenes);
+            purgarCaducadas(mascaras);
+            entradasTrasPurga = imagenes.size() + mascaras.size();
+        }
+    }
+
+    QFileInfo info(ruta);
+    FirmaArchivo firma;
+    if (info.exists()) {
+        firma.tamano = info.size();
+        firma.modificado = info.lastModified().toMSecsSinceEpoch();
+    }
+
+    // Solo se bloquea quien pide este mismo archivo mientras otro lo decodifica
+    lock_guard<mutex> lock(entrada->cerrojo);
+    shared_ptr<const T> valor = entrada->valor.lock();
+    if (valor && entrada->firma == firma) {
+        lock_guard<mutex> lockAlmacen(cerrojo);
+        numReutilizaciones++;
+        retener(claveCache, valor, bytesRecurso(*valor));
+        return valor;
+    }
+
+    valor = cargar(ruta);
+    if (valor) {
+        entrada->valor = valor;
+        entrada->firma = firma;
+        lock_guard<mutex> lockAlmacen(cerrojo);
+        numDecodificaciones++;
+        retener(claveCache, valor, bytesRecurso(*valor));
+    }
+    return valor;
+}
+
+// Quita las entradas cuyo recurso ya se libero y que nadie esta pidiendo (con `cerrojo` tomado)
+template <class T>
+void AlmacenRecursos::purgarCaducadas(unordered_map<string, shared_ptr<Entrada<T>>>& mapa) {
+    for (auto it = mapa.begin(); it != mapa.end();) {
+        if (it->second.use_count() == 1 && it->second->valor.expired()) {
+            it = mapa.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+// Marca un recurso como el mas reciente de la cache LRU (con `cerrojo` tomado)
+void AlmacenRecursos::retener(const string& clave, shared_ptr<const void> recurso, size_t bytes) {
+    if (capacidadCache == 0) return;
+
+    auto posicion = posicionesCache.find(clave);
+    if (posicion != posicionesCache.end()) {
+        bytesRetenidos -= posicion->second->bytes;
+        cache.erase(posicion->second);
+        posicionesCache.erase(posicion);
+    }
+    if (bytes > capacidadCache) return;
+
+    cache.push_front(Retenido{ clave, move(recurso), bytes });
+    posicionesCache[clave] = cache.begin();
+    bytesRetenidos += bytes;
+    recortarCache();
+}
+
+// Descarta los recursos usados hace mas tiempo hasta entrar en la capacidad (con `cerrojo` tomado)
+void AlmacenRecursos::recortarCache() {
+    while (bytesRetenidos > capacidadCache) {
+        bytesRetenidos -= cache.back().bytes;
+        posicionesCache.erase(cache.back().clave);
+        cache.pop_back();
+    }
+}
+
+/**
+ * @brief Imagen decodificada de `ruta` (nullptr si no se pudo cargar).
+ *
+ * @see CargarImagen
+ */
+shared_ptr<const Imagen> AlmacenRecursos::imagen(const QString& ruta) {
+    return obtener(imagenes, ruta, cargarImagen);
+}
+
+/**
+ * @brief Datos de enmascaramiento de `ruta` (nullptr si no se pudo cargar).
+ *
+ * @see loadSeedMasking
+ */
+shared_ptr<const MascaraCargada> AlmacenRecursos::mascara(const QString& ruta) {
+    return obtener(mascaras, ruta, cargarMascara);
+}
+
+/**
+ * @brief Archivos decodificados desde el inicio de la ejecucion.
+ */
+int AlmacenRecursos::decodificaciones() const {
+    lock_guard<mutex> lock(cerrojo);
+    return numDecodificaciones;
+}
+
+/**
+ * @brief Pedidos atendidos con un recurso que ya estaba cargado.
+ */
+int AlmacenRecursos::reutilizaciones() const {
+    lock_guard<mutex> lock(cerrojo);
+    return numReutilizaciones;
+}
+
+/**
+ * @brief Bytes de recursos decodificados que se retienen aunque nadie los use (0: ninguno).
+ *
+ * Si la nueva capacidad es menor, se descartan los recursos usados hace mas tiempo.
+ */
+void AlmacenRecursos::establecerCapacidadCache(size_t bytes) {
+    lock_guard<mutex> lock(cerrojo);
+    capacidadCache = bytes;
+    recortarCache();
+}
+
+/**
+ * @brief Bytes retenidos ahora mismo por la cache LRU.
+ */
+size_t AlmacenRecursos::bytesCache() const {
+    lock_guard<mutex> lock(cerrojo);
+    return bytesRetenidos;
+}
@@ -0,0 +1,100 @@
+#ifndef RECURSOS_H
+#define RECURSOS_H
+
+#include <QString>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "imagen.h"
+
+/**
+ * Datos de enmascaramiento de un archivo M*.txt (semilla y sumas esperadas), compartidos
+ * y de solo lectura.
+ */
+struct MascaraCargada {
+    unsigned int* datos = nullptr;
+    long long semilla = 0;
+    int numPixeles = 0;
+
+    MascaraCargada() = default;
+    MascaraCargada(const MascaraCargada&) = delete;
+    MascaraCargada& operator=(const MascaraCargada&) = delete;
+    ~MascaraCargada() { delete[] datos; }
+};
+
+/**
+ * Almacen de recursos de una ejecucion: cada archivo se decodifica la primera vez que
+ * alguien lo pide y los demas reciben la misma copia. Las imagenes se guardan como
+ * `Imagen` (RGB empaquetado, fila superior primero, buffer alineado).
+ *
+ * Devuelve `shared_ptr` a recursos de solo lectura y guarda solo referencias debiles,
+ * asi un recurso se libera cuando lo suelta su ultimo usuario (por ejemplo, al liberar
+ * un caso del lote) y nunca hay dos copias residentes del mismo archivo. Si varios
+ * hilos piden a la vez un recurso que no esta cargado, uno lo decodifica y los demas
+ * esperan ese resultado. Los fallos no se recuerdan: se reintentan en el siguiente pedido.
+ *
+ * Con `establecerCapacidadCache` (modo servidor) ademas se retienen los recursos usados
+ * mas recientemente hasta ese numero de bytes, aunque nadie los use, para que los
+ * siguientes trabajos los encuentren decodificados. Cada pedido compara el tamano y la
+ * fecha de modificacion del archivo con los de la copia guardada y lo vuelve a
+ * decodificar si cambio en disco.
+ */
+class AlmacenRecursos {
+public:
+    static AlmacenRecursos& global();
+
+    std::shared_ptr<const Imagen> imagen(const QString& ruta);
+    std::shared_ptr<const MascaraCargada> mascara(const QString& ruta);
+
+    int decodificaciones() const;
+    int reutilizaciones() const;
+
+    void establecerCapacidadCache(size_t bytes);
+    size_t bytesCache() const;
+
+private:
+    // Tamano y fecha de modificacion del archivo del que se decodifico un recurso
+    struct FirmaArchivo {
+        long long tamano = -1;
+        long long modificado = 0;
+        bool operator==(const FirmaArchivo& otra) const { return tamano == otra.tamano && modificado == otra.modificado; }
+    };
+
+    template <class T>
+    struct Entrada {
+        std::mutex cerrojo;     // se mantiene mientras se decodifica
+        std::weak_ptr<const T> valor;
+        FirmaArchivo firma;
+    };
+
+    // Recurso retenido por la cache LRU (el mas reciente esta al frente)
+    struct Retenido {
+        std::string clave;
+        std::shared_ptr<const void> recurso;
+        size_t bytes;
+    };
+
+    template <class T>
+    std::shared_ptr<const T> obtener(std::unordered_map<std::string, std::shared_ptr<Entrada<T>>>& mapa,
+                                     const QString& ruta, std::shared_ptr<const T> (*cargar)(const QString&));
+    void retener(const std::string& clave, std::shared_ptr<const void> recurso, size_t bytes);
+    void recortarCache();
+    template <class T>
+    void purgarCaducadas(std::unordered_map<std::string, std::shared_ptr<Entrada<T>>>& mapa);
+
+    mutable std::mutex cerrojo;
+    std::unordered_map<std::string, std::shared_ptr<Entrada<Imagen>>> imagenes;
+    std::unordered_map<std::string, std::shared_ptr<Entrada<MascaraCargada>>> mascaras;
+    int numDecodificaciones = 0;
+    int numReutilizaciones = 0;
+    std::list<Retenido> cache;
+    std::unordered_map<std::string, std::list<Retenido>::iterator> posicionesCache;
+    size_t capacidadCache = 0;   // 0: no se retiene nada (cada recurso vive mientras alguien lo use)
+    size_t bytesRetenidos = 0;
+    size_t entradasTrasPurga = 0;
+};
+
+#endif // RECURSOS_H
@@ -0,0 +1,138 @@
+#include "registro.h"
+#include <cstring>
+#include <iostream>
+
+using namespace std;
+
+atomic<int> nivelRegistro(NIVEL_INFO);
+
+// Destino del hilo actual (nullptr: consola)
+static thread_local SalidaCaso* salidaHilo = nullptr;
+
+// Protege la consola al volcar la salida completa de un caso
+static mutex cerrojoConsola;
+
+string SalidaCaso::texto() {
+    lock_guard<mutex> lock(cerrojo);
+    return buffer;
+}
+
+int SalidaCaso::overflow(int c) {
+    if (c != traits_type::eof()) {
+        lock_guard<mutex> lock(cerrojo);
+        buffer.push_back((char)c);
+    }
+    return c;
+}
+
+streamsize SalidaCaso::xsputn(const char* s, streamsize n) {
+    lock_guard<mutex> lock(cerrojo);
+    buffer.append(s, (size_t)n);
+    return n;
+}
+
+void SalidaPorLineas::vaciar() {
+    lock_guard<mutex> lock(cerrojoLinea);
+    if (linea.empty()) return;
+    entregar(linea);
+    linea.clear();
+}
+
+int SalidaPorLineas::overflow(int c) {
+    if (c != traits_type::eof()) {
+        char caracter = (char)c;
+        xsputn(&caracter, 1);
+    }
+    return c;
+}
+
+streamsize SalidaPorLineas::xsputn(const char* s, streamsize n) {
+    lock_guard<mutex> lock(cerrojoLinea);
+    for (streamsize i = 0; i < n; i++) {
+        if (s[i] == '\n') {
+            entregar(linea);
+            linea.clear();
+        } else {
+            linea.push_back(s[i]);
+        }
+    }
+    return n;
+}
+
+SalidaCaso* SalidaActual() {
+    return salidaHilo;
+}
+
+void EstablecerSalida(SalidaCaso* destino) {
+    salidaHilo = destino;
+}
+
+/**
+ * @brief Escribe en la consola todo lo acumulado por un caso, sin intercalarlo con otros.
+ */
+void ImprimirSalidaCaso(SalidaCaso& destino) {
+    string texto = destino.texto();
+    lock_guard<mutex> lock(cerrojoConsola);
+    cout << texto << flush;
+}
+
+// Cada hilo usa su propio ostream sobre el buffer compartido del caso, porque
+// un mismo ostream no se puede usar desde varios hilos a la vez.
+static ostream& flujoHilo(ostream& consola) {
+    if (!salidaHilo) return consola;
+
+    static thread_local ostream flujo(nullptr);
+    if (flujo.rdbuf() != salidaHilo) flujo.rdbuf(salidaHilo);
+    return flujo;
+}
+
+// Flujo sin buffer: descarta todo lo que se escribe
+static ostream& flujoNulo() {
+    static thread_local ostream nulo(nullptr);
+    nulo.clear();
+    return nulo;
+}
+
+void EstablecerNivelRegistro(NivelRegistro nivel) {
+    nivelRegistro.store(nivel);
+}
+
+/**
+ * @brief Convierte "error", "aviso", "info" o "depuracion" en su nivel.
+ */
+bool NivelRegistroDesdeTexto(const char* texto, NivelRegistro& nivel) {
+    static const char* const NOMBRES[] = { "error", "aviso", "info", "depuracion" };
+    for (int i = 0; i <= NIVEL_DEPURACION; i++) {
+        if (strcmp(texto, NOMBRES[i]) == 0) {
+            nivel = (NivelRegistro)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Flujo para un nivel: el caso actual, `cerr` (errores y avisos) o `cout`.
+ *
+ * Si el nivel no esta habilitado devuelve un flujo que descarta todo. Los mensajes
+ * terminan en '\n' y no en `endl`: la consola se vacia al imprimir cada caso, no en
+ * cada linea.
+ */
+ostream& FlujoRegistro(NivelRegistro nivel) {
+    if (!RegistroHabilitado(nivel)) return flujoNulo();
+    return flujoHilo(nivel <= NIVEL_AVISO ? cerr : cout);
+}
+
+/**
+ * @brief Flujo para mensajes normales (NIVEL_INFO): el caso actual o `cout`.
+ */
+ostream& salida() {
+    return FlujoRegistro(NIVEL_INFO);
+}
+
+/**
+ * @brief Flujo para errores: el caso actual (en orden con los demas mensajes) o `cerr`.
+ */
+ostream& salidaError() {
+    return FlujoRegistro(NIVEL_ERROR);
+}
@@ -0,0 +1,105 @@
+#ifndef REGISTRO_H
+#define REGISTRO_H
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+/**
+ * Niveles de los mensajes, de mas a menos importante. Solo se escriben los mensajes
+ * con nivel menor o igual al configurado con `EstablecerNivelRegistro` (por defecto
+ * NIVEL_INFO).
+ */
+enum NivelRegistro {
+    NIVEL_ERROR = 0,
+    NIVEL_AVISO = 1,
+    NIVEL_INFO = 2,
+    NIVEL_DEPURACION = 3
+};
+
+// Con DESAFIO_SIN_DEPURACION los mensajes de depuracion se eliminan al compilar
+#ifdef DESAFIO_SIN_DEPURACION
+const bool DEPURACION_COMPILADA = false;
+#else
+const bool DEPURACION_COMPILADA = true;
+#endif
+
+extern std::atomic<int> nivelRegistro;
+
+inline bool RegistroHabilitado(NivelRegistro nivel) {
+    return nivel <= nivelRegistro.load(std::memory_order_relaxed);
+}
+
+void EstablecerNivelRegistro(NivelRegistro nivel);
+bool NivelRegistroDesdeTexto(const char* texto, NivelRegistro& nivel);
+std::ostream& FlujoRegistro(NivelRegistro nivel);
+
+// Los argumentos solo se evaluan si el nivel esta habilitado
+#define REGISTRO(nivel) if (!RegistroHabilitado(nivel)) {} else FlujoRegistro(nivel)
+#define REGISTRO_AVISO REGISTRO(NIVEL_AVISO)
+#define REGISTRO_DEPURACION if (!DEPURACION_COMPILADA || !RegistroHabilitado(NIVEL_DEPURACION)) {} else FlujoRegistro(NIVEL_DEPURACION)
+
+/**
+ * Destino de los mensajes de un caso. Acumula el texto en memoria (de forma segura
+ * entre hilos) para imprimirlo de una sola vez al terminar el caso, asi la salida
+ * de varios casos procesados a la vez no se mezcla.
+ */
+class SalidaCaso : public std::streambuf {
+public:
+    std::string texto();
+
+protected:
+    int overflow(int c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+private:
+    std::mutex cerrojo;
+    std::string buffer;
+};
+
+/**
+ * Destino que no acumula el texto: entrega cada linea completa (sin el '\n') a una
+ * funcion en cuanto se escribe, por ejemplo para enviarla a un cliente. `vaciar`
+ * entrega la ultima linea si quedo sin terminar.
+ */
+class SalidaPorLineas : public SalidaCaso {
+public:
+    explicit SalidaPorLineas(std::function<void(const std::string&)> entregar) : entregar(std::move(entregar)) {}
+    void vaciar();
+
+protected:
+    int overflow(int c) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+
+private:
+    std::function<void(const std::string&)> entregar;
+    std::mutex cerrojoLinea;
+    std::string linea;
+};
+
+SalidaCaso* SalidaActual();
+void EstablecerSalida(SalidaCaso* destino);
+void ImprimirSalidaCaso(SalidaCaso& destino);
+
+std::ostream& salida();
+std::ostream& salidaError();
+
+/**
+ * Redirige los mensajes del hilo actual a `destino` mientras exista el objeto.
+ */
+class AmbitoSalida {
+public:
+    explicit AmbitoSalida(SalidaCaso* destino) : anterior(SalidaActual()) { EstablecerSalida(destino); }
+    ~AmbitoSalida() { EstablecerSalida(anterior); }
+
+    AmbitoSalida(const AmbitoSalida&) = delete;
+    AmbitoSalida& operator=(const AmbitoSalida&) = delete;
+
+private:
+    SalidaCaso* anterior;
+};
+
+#endif // REGISTRO_H
@@ -0,0 +1,387 @@
+#include "servidor.h"
+#include <iostream>
+
+#ifdef _WIN32
+
+using namespace std;
+
+int EjecutarServidor(const QString&, size_t, const EjecutorTrabajos&) {
+    cerr << "El modo servidor usa sockets Unix y no esta disponible en Windows\n";
+    return 1;
+}
+
+#else
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "hilos.h"
+#include "recursos.h"
+#include "registro.h"
+
+using namespace std;
+
+// Conexion con un cliente. Los trabajos de la conexion envian sus eventos desde los
+// hilos del pool; el descriptor se cierra cuando el ultimo de ellos la suelta.
+class ConexionServidor {
+public:
+    explicit ConexionServidor(int descriptor) : descriptor(descriptor) {}
+    ~ConexionServidor() { close(descriptor); }
+
+    ConexionServidor(const ConexionServidor&) = delete;
+    ConexionServidor& operator=(const ConexionServidor&) = delete;
+
+    int fd() const { return descriptor; }
+    void enviar(const QJsonObject& evento);
+    void cerrarLectura() { shutdown(descriptor, SHUT_RD); }
+
+private:
+    int descriptor;
+    mutex cerrojo;
+    bool rota = false;   // el cliente se desconecto: los eventos se descartan
+};
+
+/**
+ * @brief Envia un evento como una linea JSON. Puede llamarse desde cualquier hilo.
+ */
+void ConexionServidor::enviar(const QJsonObject& evento) {
+    QByteArray json = QJsonDocument(evento).toJson(QJsonDocument::Compact);
+    string linea(json.constData(), (size_t)json.size());
+    linea += '\n';
+
+    lock_guard<mutex> lock(cerrojo);
+    size_t enviados = 0;
+    while (!rota && enviados < linea.size()) {
+        ssize_t n = write(descriptor, linea.data() + enviados, linea.size() - enviados);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            rota = true;
+        } else {
+            enviados += (size_t)n;
+        }
+    }
+}
+
+struct EstadoServidor {
+    const EjecutorTrabajos& ejecutar;
+    atomic<bool> detener{false};
+    atomic<int> ultimoTrabajo{0};
+    mutex cerrojoCasos{};
+    set<QString> casosEnCurso{};   // directorios reales de los casos con un trabajo en curso
+};
+
+// Directorio real del caso, para reconocerlo aunque se escriba de otra forma
+static QString claveCaso(const QString& rutaBase) {
+    QString canonica = QFileInfo(rutaBase).canonicalFilePath();
+    return canonica.isEmpty() ? rutaBase : canonica;
+}
+
+// Libera el caso de un trabajo al terminar, tambien si el trabajo lanza una excepcion
+class ReservaCaso {
+public:
+    ReservaCaso(EstadoServidor& estado, const QString& clave) : estado(estado), clave(clave) {}
+    ~ReservaCaso() {
+        lock_guard<mutex> lock(estado.cerrojoCasos);
+        estado.casosEnCurso.erase(clave);
+    }
+
+    ReservaCaso(const ReservaCaso&) = delete;
+    ReservaCaso& operator=(const ReservaCaso&) = delete;
+
+private:
+    EstadoServidor& estado;
+    QString clave;
+};
+
+static void enviarError(ConexionServidor& conexion, const char* mensaje) {
+    QJsonObject evento;
+    evento["tipo"] = "error";
+    evento["mensaje"] = mensaje;
+    conexion.enviar(evento);
+}
+
+/**
+ * @brief Lee el campo entero opcional `campo` de una peticion (si falta, deja `resultado`).
+ *
+ * @return false Si el valor no es un numero entero mayor o igual que 0.
+ */
+static bool leerEnteroPeticion(const QJsonObject& peticion, const char* campo, int& resultado) {
+    QJsonValue valor = peticion.value(campo);
+    if (valor.isUndefined()) return true;
+    double numero = valor.toDouble();
+    if (!valor.isDouble() || numero < 0 || numero > INT_MAX || numero != floor(numero)) return false;
+    resultado = (int)numero;
+    return true;
+}
+
+/**
+ * @brief Atiende una linea del cliente: una orden o un trabajo, que se encola en el pool.
+ */
+static void atenderPeticion(EstadoServidor& estado, const shared_ptr<ConexionServidor>& conexion, GrupoTareas& trabajos, const string& linea) {
+    if (linea.find_first_not_of(" \t\r") == string::npos) return;
+
+    QJsonParseError error;
+    QJsonDocument documento = QJsonDocument::fromJson(QByteArray(linea.data(), (int)linea.size()), &error);
+    if (error.error != QJsonParseError::NoError || !documento.isObject()) {
+        enviarError(*conexion, "peticion no valida: se espera un objeto JSON por linea");
+        return;
+    }
+    QJsonObject peticion = documento.object();
+
+    QString orden = peticion.value("orden").toString();
+    if (orden == "estado") {
+        AlmacenRecursos& almacen = AlmacenRecursos::global();
+        QJsonObject evento;
+        evento["tipo"] = "estado";
+        evento["hilos"] = PoolHilos::global().numHilos();
+        evento["trabajos"] = estado.ultimoTrabajo.load();
+        evento["decodificaciones"] = almacen.decodificaciones();
+        evento["reutilizaciones"] = almacen.reutilizaciones();
+        evento["bytesCache"] = (double)almacen.bytesCache();
+        conexion->enviar(evento);
+        return;
+    }
+    if (orden == "detener") {
+        estado.detener = true;
+        QJsonObject evento;
+        evento["tipo"] = "detenido";
+        conexion->enviar(evento);
+        return;
+    }
+    if (!orden.isEmpty()) {
+        enviarError(*conexion, "orden desconocida (se aceptan \"estado\" y \"detener\")");
+        return;
+    }
+
+    TrabajoServidor trabajo;
+    trabajo.rutaBase = QDir::fromNativeSeparators(peticion.value("caso").toString());
+    if (trabajo.rutaBase.isEmpty()) {
+        enviarError(*conexion, "el trabajo no indica el directorio del caso (\"caso\")");
+        return;
+    }
+    if (!trabajo.rutaBase.endsWith('/')) trabajo.rutaBase += '/';
+    if (!leerEnteroPeticion(peticion, "etapas", trabajo.numEtapas)) {
+        enviarError(*conexion, "\"etapas\" debe ser un entero mayor o igual que 0 (0: contar los M*.txt)");
+        return;
+    }
+    if (!leerEnteroPeticion(peticion, "bandas", trabajo.filasPorBanda)) {
+        enviarError(*conexion, "\"bandas\" debe ser un entero mayor o igual que 0 (0: imagen completa en memoria)");
+        return;
+    }
+    trabajo.modoPlanificado = peticion.value("planificado").toBool(false);
+    trabajo.exportarIntermedias = peticion.value("intermedias").toBool(true);
+    trabajo.reanudar = peticion.value("reanudar").toBool(true);
+
+    // Dos trabajos sobre el mismo caso escribirian los mismos archivos a la vez
+    QString clave = claveCaso(trabajo.rutaBase);
+    {
+        lock_guard<mutex> lock(estado.cerrojoCasos);
+        if (!estado.casosEnCurso.insert(clave).second) {
+            enviarError(*conexion, "el caso ya tiene un trabajo en curso; reintentar cuando termine");
+            return;
+        }
+    }
+
+    int id = ++estado.ultimoTrabajo;
+    QJsonObject aceptado;
+    aceptado["trabajo"] = id;
+    aceptado["tipo"] = "aceptado";
+    aceptado["caso"] = trabajo.rutaBase;
+    conexion->enviar(aceptado);
+
+    PoolHilos::global().encolar(trabajos, [&estado, conexion, trabajo, id, clave] {
+        // Cada linea de mensajes del trabajo se envia como un evento "salida"
+        SalidaPorLineas salidaTrabajo([&conexion, id](const string& linea) {
+            QJsonObject evento;
+            evento["trabajo"] = id;
+            evento["tipo"] = "salida";
+            evento["texto"] = QString::fromStdString(linea);
+            conexion->enviar(evento);
+        });
+        chrono::steady_clock::time_point inicio = chrono::steady_clock::now();
+        bool exito = false;
+        QString error;
+        {
+            // Un trabajo que lanza una excepcion falla solo: el servidor y los demas siguen
+            ReservaCaso reserva(estado, clave);
+            try {
+                AmbitoSalida ambito(&salidaTrabajo);
+                exito = estado.ejecutar(trabajo);
+            } catch (const exception& e) {
+                error = QString::fromStdString(string("excepcion durante el trabajo: ") + e.what());
+            } catch (...) {
+                error = "excepcion desconocida durante el trabajo";
+            }
+            salidaTrabajo.vaciar();
+        }
+
+        QJsonObject fin;
+        fin["trabajo"] = id;
+        fin["tipo"] = "fin";
+        fin["exito"] = exito;
+        if (!error.isEmpty()) fin["error"] = error;
+        fin["ms"] = chrono::duration<double, milli>(chrono::steady_clock::now() - inicio).count();
+        conexion->enviar(fin);
+    });
+}
+
+/**
+ * @brief Lee las peticiones de un cliente hasta que cierre su extremo de escritura y
+ * espera a que terminen sus trabajos.
+ */
+static void atenderConexion(EstadoServidor& estado, shared_ptr<ConexionServidor> conexion) {
+    GrupoTareas trabajos;
+    string pendiente;
+    char bloque[4096];
+    while (true) {
+        ssize_t n = read(conexion->fd(), bloque, sizeof(bloque));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+
+        pendiente.append(bloque, (size_t)n);
+        size_t fin;
+        while ((fin = pendiente.find('\n')) != string::npos) {
+            string linea = pendiente.substr(0, fin);
+            pendiente.erase(0, fin + 1);
+            atenderPeticion(estado, conexion, trabajos, linea);
+        }
+    }
+    atenderPeticion(estado, conexion, trabajos, pendiente);
+    PoolHilos::global().esperar(trabajos);
+}
+
+// Hilo que atiende una conexion; `terminado` permite unirlo sin esperar a los demas
+struct HiloConexion {
+    thread hilo;
+    weak_ptr<ConexionServidor> conexion;
+    shared_ptr<atomic<bool>> terminado;
+};
+
+/**
+ * @brief Atiende trabajos en el socket Unix `rutaSocket` hasta recibir la orden "detener".
+ *
+ * Cada conexion se lee en su propio hilo y sus trabajos se ejecutan en el pool global,
+ * asi varios clientes (o varios trabajos de un mismo cliente) se procesan a la vez. Al
+ * detenerse deja de aceptar peticiones y espera a que terminen los trabajos en curso.
+ *
+ * @param rutaSocket Ruta del socket (si quedo uno de una ejecucion anterior, se reemplaza).
+ * @param capacidadCache Bytes de imagenes y mascaras decodificadas que se retienen entre trabajos.
+ * @param ejecutar Funcion que reconstruye un caso.
+ *
+ * @return 0 al detenerse normalmente; 1 si no se pudo abrir el socket.
+ */
+int EjecutarServidor(const QString& rutaSocket, size_t capacidadCache, const EjecutorTrabajos& ejecutar) {
+    string ruta = rutaSocket.toStdString();
+    sockaddr_un direccion;
+    memset(&direccion, 0, sizeof(direccion));
+    direccion.sun_family = AF_UNIX;
+    if (ruta.empty() || ruta.size() >= sizeof(direccion.sun_path)) {
+        cerr << "Error: ruta de socket vacia o demasiado larga: " << ruta << '\n';
+        return 1;
+    }
+    memcpy(direccion.sun_path, ruta.c_str(), ruta.size() + 1);
+
+    int escucha = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (escucha < 0) {
+        cerr << "Error: no se pudo crear el socket: " << strerror(errno) << '\n';
+        return 1;
+    }
+
+    // Un socket de una ejecucion anterior se reemplaza, pero no uno con un servidor
+    // vivo ni un archivo que no sea un socket
+    struct stat info;
+    if (lstat(ruta.c_str(), &info) == 0) {
+        bool enUso = S_ISSOCK(info.st_mode) && connect(escucha, (const sockaddr*)&direccion, sizeof(direccion)) == 0;
+        if (!S_ISSOCK(info.st_mode) || enUso) {
+            cerr << "Error: " << ruta << (enUso ? " ya tiene un servidor activo\n" : " existe y no es un socket\n");
+            close(escucha);
+            return 1;
+        }
+        unlink(ruta.c_str());
+    }
+
+    // Los trabajos leen y escriben archivos con los permisos del servidor: el socket se
+    // crea ya accesible solo para su usuario, sin un intervalo abierto a los demas
+    mode_t mascaraAnterior = umask(S_IRWXG | S_IRWXO);
+    bool escuchando = bind(escucha, (const sockaddr*)&direccion, sizeof(direccion)) == 0 && listen(escucha, 16) == 0;
+    int errorEscucha = errno;
+    umask(mascaraAnterior);
+    if (!escuchando) {
+        cerr << "Error: no se pudo escuchar en " << ruta << ": " << strerror(errorEscucha) << '\n';
+        close(escucha);
+        return 1;
+    }
+
+    // Un cliente que se desconecta no debe terminar el proceso al escribirle
+    signal(SIGPIPE, SIG_IGN);
+    AlmacenRecursos::global().establecerCapacidadCache(capacidadCache);
+
+    cout << "Servidor escuchando en " << ruta << " (cache de "
+         << capacidadCache / (1024 * 1024) << " MiB, " << PoolHilos::global().numHilos() << " hilos)" << endl;
+
+    EstadoServidor estado{ ejecutar };
+    vector<HiloConexion> conexiones;
+    while (!estado.detener) {
+        // Espera acotada para revisar `detener` y unir los hilos de conexiones cerradas
+        pollfd espera = { escucha, POLLIN, 0 };
+        int listo = poll(&espera, 1, 200);
+        for (size_t i = 0; i < conexiones.size();) {
+            if (conexiones[i].terminado->load()) {
+                conexiones[i].hilo.join();
+                conexiones.erase(conexiones.begin() + i);
+            } else {
+                i++;
+            }
+        }
+        if (listo < 0 && errno != EINTR) break;
+        if (listo <= 0) continue;
+
+        int cliente = accept(escucha, nullptr, nullptr);
+        if (cliente < 0) continue;
+
+        shared_ptr<ConexionServidor> conexion = make_shared<ConexionServidor>(cliente);
+        shared_ptr<atomic<bool>> terminado = make_shared<atomic<bool>>(false);
+        conexiones.push_back(HiloConexion{ thread([&estado, conexion, terminado] {
+            atenderConexion(estado, conexion);
+            terminado->store(true);
+        }), conexion, terminado });
+    }
+
+    close(escucha);
+    unlink(ruta.c_str());
+
+    // Las conexiones abiertas dejan de leer peticiones; sus trabajos en curso terminan
+    for (HiloConexion& abierta : conexiones) {
+        shared_ptr<ConexionServidor> conexion = abierta.conexion.lock();
+        if (conexion) conexion->cerrarLectura();
+    }
+    for (HiloConexion& abierta : conexiones) {
+        abierta.hilo.join();
+    }
+    AlmacenRecursos::global().establecerCapacidadCache(0);
+    cout << "Servidor detenido: " << estado.ultimoTrabajo.load() << " trabajos atendidos" << endl;
+    return 0;
+}
+
+#endif
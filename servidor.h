@@ -0,0 +1,41 @@
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <QString>
+#include <cstddef>
+#include <functional>
+
+// Trabajo de reconstruccion recibido por el servidor (un caso y sus opciones)
+struct TrabajoServidor {
+    QString rutaBase;               // directorio del caso, terminado en '/'
+    int numEtapas = 0;              // 0: contar los archivos M*.txt del caso
+    bool modoPlanificado = false;
+    bool exportarIntermedias = true;
+    bool reanudar = true;
+    int filasPorBanda = 0;
+};
+
+// Ejecuta un trabajo; sus mensajes (salida() y salidaError()) se envian al cliente
+typedef std::function<bool(const TrabajoServidor&)> EjecutorTrabajos;
+
+const size_t CAPACIDAD_CACHE_SERVIDOR = (size_t)1024 * 1024 * 1024;
+
+/**
+ * Modo servidor: un proceso residente que recibe trabajos por un socket Unix local.
+ *
+ * El protocolo es JSON por lineas. Cada linea del cliente es un trabajo
+ * (`{"caso": "...", "etapas": 0, "planificado": false, "intermedias": true,
+ * "reanudar": true, "bandas": 0}`, todos los campos salvo "caso" son opcionales) o una
+ * orden (`{"orden": "estado"}`, `{"orden": "detener"}`). Los trabajos se ejecutan en el
+ * pool de hilos y el servidor responde con eventos por lineas: "aceptado", una "salida"
+ * por cada linea de mensajes del trabajo a medida que se escribe (cada etapa se informa
+ * al terminar) y "fin" con el resultado y la duracion ("error" si el trabajo lanzo una
+ * excepcion). Un trabajo sobre un caso que ya tiene otro en curso, o con "etapas" o
+ * "bandas" que no sean enteros mayores o iguales que 0, se rechaza con un evento "error".
+ *
+ * Las imagenes y mascaras decodificadas quedan en la cache LRU del `AlmacenRecursos`,
+ * asi los trabajos que comparten M.bmp o I_M.bmp no las vuelven a decodificar.
+ */
+int EjecutarServidor(const QString& rutaSocket, size_t capacidadCache, const EjecutorTrabajos& ejecutar);
+
+#endif // SERVIDOR_H
@@ -0,0 +1,17 @@
+# Prueba de los nucleos SIMD: cada variante soportada por la CPU debe dar exactamente
+# la misma salida que la escalar. Se compila aparte de BETA2.pro; `make check` la ejecuta.
+
+TEMPLATE = app
+CONFIG += console c++17 testcase
+CONFIG -= app_bundle qt
+TARGET = prueba_kernels
+
+INCLUDEPATH += ../..
+
+SOURCES += prueba_kernels.cpp \
+    ../../operaciones_simd.cpp \
+    ../../registro.cpp
+
+HEADERS += \
+    ../../operaciones_simd.h \
+    ../../registro.h
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "operaciones_simd.h"
+
+using namespace std;
+
+/*
+ * Compara cada variante de `KernelsOperaciones` con la escalar, byte a byte, sobre
+ * longitudes aleatorias (incluidas 0 y las que no son multiplo de 16, 32 ni 64) y
+ * desplazamientos aleatorios respecto de la alineacion de los buffers. Las variantes
+ * que la CPU no soporta se omiten. Tambien comprueba que el digesto escalar cambia al
+ * intercambiar dos franjas. Devuelve 1 si algo falla.
+ */
+
+const int ITERACIONES = 200;
+const size_t MAX_LONGITUD = 5000;
+const size_t MAX_DESPLAZAMIENTO = 64;
+
+// Longitudes de borde que se prueban siempre, antes de las aleatorias
+static const size_t LONGITUDES_FIJAS[] = { 0, 1, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 129, 255, 257 };
+
+struct Prueba {
+    mt19937_64 azar{ 0x5eed };
+    int fallos = 0;
+
+    size_t numero(size_t maximo) { return (size_t)(azar() % (maximo + 1)); }
+
+    void llenar(vector<unsigned char>& buffer) {
+        for (unsigned char& byte : buffer) byte = (unsigned char)azar();
+    }
+
+    void fallo(const char* variante, const char* kernel, size_t longitud, const char* detalle) {
+        if (fallos < 20) {
+            printf("FALLO %s.%s (longitud %zu): %s\n", variante, kernel, longitud, detalle);
+        }
+        fallos++;
+    }
+};
+
+// Buffer con holgura para empezar en cualquier desplazamiento
+struct BufferDesplazado {
+    vector<unsigned char> memoria;
+    size_t desplazamiento;
+
+    BufferDesplazado(Prueba& prueba, size_t longitud)
+        : memoria(longitud + MAX_DESPLAZAMIENTO), desplazamiento(prueba.numero(MAX_DESPLAZAMIENTO - 1)) {
+        prueba.llenar(memoria);
+    }
+    unsigned char* datos() { return memoria.data() + desplazamiento; }
+};
+
+static void probarLongitud(Prueba& prueba, const KernelsOperaciones& ref, const KernelsOperaciones& k, size_t n) {
+    BufferDesplazado a(prueba, n), b(prueba, n), esperado(prueba, n), obtenido(prueba, n);
+
+    // xorBytes, tambien en el lugar
+    ref.xorBytes(a.datos(), b.datos(), esperado.datos(), n);
+    k.xorBytes(a.datos(), b.datos(), obtenido.datos(), n);
+    if (memcmp(esperado.datos(), obtenido.datos(), n) != 0) prueba.fallo(k.nombre, "xorBytes", n, "salida distinta");
+    memcpy(obtenido.datos(), a.datos(), n);
+    k.xorBytes(obtenido.datos(), b.datos(), obtenido.datos(), n);
+    if (memcmp(esperado.datos(), obtenido.datos(), n) != 0) prueba.fallo(k.nombre, "xorBytes", n, "salida distinta en el lugar");
+
+    // rotarIzquierdaBytes de 0 a 8 bits
+    for (int bits = 0; bits <= 8; bits++) {
+        ref.rotarIzquierdaBytes(a.datos(), esperado.datos(), n, bits);
+        k.rotarIzquierdaBytes(a.datos(), obtenido.datos(), n, bits);
+        if (memcmp(esperado.datos(), obtenido.datos(), n) != 0) {
+            char detalle[64];
+            snprintf(detalle, sizeof(detalle), "salida distinta con %d bits", bits);
+            prueba.fallo(k.nombre, "rotarIzquierdaBytes", n, detalle);
+        }
+    }
+
+    // sumarBytes
+    ref.sumarBytes(a.datos(), b.datos(), esperado.datos(), n);
+    k.sumarBytes(a.datos(), b.datos(), obtenido.datos(), n);
+    if (memcmp(esperado.datos(), obtenido.datos(), n) != 0) prueba.fallo(k.nombre, "sumarBytes", n, "salida distinta");
+
+    // acumularDigesto sobre las franjas completas, partiendo de acumuladores y de una
+    // posicion de la primera franja aleatorios
+    size_t numFranjas = n / BYTES_FRANJA_DIGESTO;
+    uint64_t primeraFranja = prueba.azar() >> prueba.numero(63);
+    uint64_t accRef[NUM_ACUMULADORES_DIGESTO], accK[NUM_ACUMULADORES_DIGESTO];
+    for (int i = 0; i < NUM_ACUMULADORES_DIGESTO; i++) accRef[i] = accK[i] = prueba.azar();
+    ref.acumularDigesto(accRef, a.datos(), numFranjas, primeraFranja);
+    k.acumularDigesto(accK, a.datos(), numFranjas, primeraFranja);
+    if (memcmp(accRef, accK, sizeof(accRef)) != 0) prueba.fallo(k.nombre, "acumularDigesto", n, "acumuladores distintos");
+
+    // contarDiferencias: sin diferencias, con algunas y con todos los bytes distintos
+    memcpy(b.datos(), a.datos(), n);
+    for (int caso = 0; caso < 3; caso++) {
+        if (caso == 1 && n > 0) {
+            size_t cambios = 1 + prueba.numero(8);
+            for (size_t c = 0; c < cambios; c++) b.datos()[prueba.numero(n - 1)] ^= (unsigned char)(1 + prueba.numero(254));
+        } else if (caso == 2) {
+            for (size_t i = 0; i < n; i++) b.datos()[i] = (unsigned char)~a.datos()[i];
+        }
+        size_t primeraRef = (size_t)-1, primeraK = (size_t)-1;
+        size_t distintosRef = ref.contarDiferencias(a.datos(), b.datos(), n, &primeraRef);
+        size_t distintosK = k.contarDiferencias(a.datos(), b.datos(), n, &primeraK);
+        if (distintosRef != distintosK || (distintosRef > 0 && primeraRef != primeraK)) {
+            prueba.fallo(k.nombre, "contarDiferencias", n, "conteo o primera posicion distintos");
+        }
+    }
+}
+
+// Intercambiar dos franjas distintas debe cambiar los acumuladores
+static void probarOrdenFranjas(Prueba& prueba, const KernelsOperaciones& k) {
+    for (int i = 0; i < ITERACIONES; i++) {
+        size_t numFranjas = 2 + prueba.numero(30);
+        vector<unsigned char> datos(numFranjas * BYTES_FRANJA_DIGESTO);
+        prueba.llenar(datos);
+        vector<unsigned char> intercambiados = datos;
+        size_t x = prueba.numero(numFranjas - 1), y = (x + 1 + prueba.numero(numFranjas - 2)) % numFranjas;
+        swap_ranges(intercambiados.begin() + x * BYTES_FRANJA_DIGESTO, intercambiados.begin() + (x + 1) * BYTES_FRANJA_DIGESTO,
+                    intercambiados.begin() + y * BYTES_FRANJA_DIGESTO);
+
+        uint64_t acc[NUM_ACUMULADORES_DIGESTO] = {}, accIntercambiados[NUM_ACUMULADORES_DIGESTO] = {};
+        k.acumularDigesto(acc, datos.data(), numFranjas, 0);
+        k.acumularDigesto(accIntercambiados, intercambiados.data(), numFranjas, 0);
+        if (memcmp(acc, accIntercambiados, sizeof(acc)) == 0) {
+            prueba.fallo(k.nombre, "acumularDigesto", datos.size(), "no detecta franjas intercambiadas");
+        }
+    }
+}
+
+int main() {
+    Prueba prueba;
+    static const char* const VARIANTES[] = { "sse2", "avx2", "avx512" };
+
+    SeleccionarKernels("escalar");
+    const KernelsOperaciones ref = KernelsActivos();
+    probarOrdenFranjas(prueba, ref);
+
+    int probadas = 0;
+    for (const char* variante : VARIANTES) {
+        if (!SeleccionarKernels(variante)) {
+            printf("%-8s omitida (la CPU no la soporta)\n", variante);
+            continue;
+        }
+        const KernelsOperaciones k = KernelsActivos();
+        int fallosAntes = prueba.fallos;
+        for (size_t n : LONGITUDES_FIJAS) probarLongitud(prueba, ref, k, n);
+        for (int i = 0; i < ITERACIONES; i++) probarLongitud(prueba, ref, k, prueba.numero(MAX_LONGITUD));
+        printf("%-8s %s\n", variante, prueba.fallos == fallosAntes ? "igual a la escalar" : "DISTINTA de la escalar");
+        probadas++;
+    }
+
+    printf("%d variantes comparadas, %d fallos\n", probadas, prueba.fallos);
+    return prueba.fallos == 0 ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+#include "traza.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <QSaveFile>
+
+using namespace std;
+
+atomic<bool> trazaActiva(false);
+
+// Eventos de un hilo. Cada hilo escribe solo en el suyo, asi el cerrojo nunca
+// se disputa salvo cuando `FinalizarTraza` los recorre.
+struct BufferTraza {
+    mutex cerrojo;
+    vector<EventoTraza> eventos;
+    int idHilo;
+};
+
+static mutex cerrojoTraza;
+static vector<shared_ptr<BufferTraza>> buffers;
+static QString rutaTraza;
+static const chrono::steady_clock::time_point origenTraza = chrono::steady_clock::now();
+
+static BufferTraza& bufferDelHilo() {
+    static thread_local shared_ptr<BufferTraza> buffer;
+    if (!buffer) {
+        buffer = make_shared<BufferTraza>();
+        lock_guard<mutex> lock(cerrojoTraza);
+        buffer->idHilo = (int)buffers.size() + 1;
+        buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+/**
+ * @brief Microsegundos transcurridos desde el inicio del programa.
+ */
+double AhoraTrazaUs() {
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - origenTraza).count();
+}
+
+/**
+ * @brief Activa la traza; los eventos se escribiran en `ruta` al llamar a `FinalizarTraza`.
+ */
+bool IniciarTraza(const QString& ruta) {
+    if (ruta.isEmpty()) return false;
+    {
+        lock_guard<mutex> lock(cerrojoTraza);
+        rutaTraza = ruta;
+    }
+    trazaActiva.store(true);
+    return true;
+}
+
+void RegistrarEventoTraza(const EventoTraza& evento) {
+    BufferTraza& buffer = bufferDelHilo();
+    lock_guard<mutex> lock(buffer.cerrojo);
+    buffer.eventos.push_back(evento);
+}
+
+/**
+ * @brief Desactiva la traza y escribe todos los eventos registrados como JSON de Chrome trace.
+ *
+ * @return true Si la traza estaba activa y se escribio el archivo.
+ */
+bool FinalizarTraza() {
+    if (!trazaActiva.exchange(false)) return false;
+
+    lock_guard<mutex> lock(cerrojoTraza);
+    string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool primero = true;
+    char linea[512];
+
+    for (const shared_ptr<BufferTraza>& buffer : buffers) {
+        lock_guard<mutex> lockBuffer(buffer->cerrojo);
+
+        snprintf(linea, sizeof(linea), "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"hilo %d\"}}",
+                 primero ? "" : ",\n", buffer->idHilo, buffer->idHilo);
+        json += linea;
+        primero = false;
+
+        for (const EventoTraza& evento : buffer->eventos) {
+            snprintf(linea, sizeof(linea), ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{",
+                     evento.nombre, evento.categoria, evento.inicioUs, evento.duracionUs, buffer->idHilo);
+            json += linea;
+            for (int i = 0; i < evento.numArgumentos; i++) {
+                snprintf(linea, sizeof(linea), "%s\"%s\":%lld", i ? "," : "", evento.claves[i], evento.valores[i]);
+                json += linea;
+            }
+            json += "}}";
+        }
+        buffer->eventos.clear();
+    }
+    json += "\n]}\n";
+
+    QSaveFile archivo(rutaTraza);
+    if (!archivo.open(QIODevice::WriteOnly)) return false;
+    archivo.write(json.data(), (qint64)json.size());
+    return archivo.commit();
+}
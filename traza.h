@@ -0,0 +1,76 @@
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <atomic>
+#include <QString>
+
+/**
+ * Trazas de tiempo en formato Chrome trace (chrome://tracing, Perfetto).
+ *
+ * Cada `AmbitoTraza` registra un evento con su duracion y argumentos (por ejemplo,
+ * los bytes procesados). La traza se activa en tiempo de ejecucion con `IniciarTraza`
+ * y se escribe con `FinalizarTraza`; mientras esta apagada cada ambito solo lee un
+ * indicador atomico, asi la instrumentacion puede quedar en el codigo de produccion.
+ */
+
+extern std::atomic<bool> trazaActiva;
+
+inline bool TrazaActiva() {
+    return trazaActiva.load(std::memory_order_relaxed);
+}
+
+bool IniciarTraza(const QString& ruta);
+bool FinalizarTraza();
+double AhoraTrazaUs();
+
+const int MAX_ARGUMENTOS_TRAZA = 3;
+
+struct EventoTraza {
+    const char* categoria;                          // literales: no se copian
+    const char* nombre;
+    double inicioUs;
+    double duracionUs;
+    int numArgumentos;
+    const char* claves[MAX_ARGUMENTOS_TRAZA];
+    long long valores[MAX_ARGUMENTOS_TRAZA];
+};
+
+void RegistrarEventoTraza(const EventoTraza& evento);
+
+/**
+ * Mide el tiempo entre su construccion y su destruccion. `categoria`, `nombre` y las
+ * claves de los argumentos deben ser literales (se guarda solo el puntero).
+ */
+class AmbitoTraza {
+public:
+    AmbitoTraza(const char* categoria, const char* nombre, long long bytes = -1) : activo(TrazaActiva()) {
+        if (!activo) return;
+        evento.categoria = categoria;
+        evento.nombre = nombre;
+        evento.numArgumentos = 0;
+        if (bytes >= 0) argumento("bytes", bytes);
+        evento.inicioUs = AhoraTrazaUs();
+    }
+
+    ~AmbitoTraza() {
+        if (!activo) return;
+        evento.duracionUs = AhoraTrazaUs() - evento.inicioUs;
+        RegistrarEventoTraza(evento);
+    }
+
+    void argumento(const char* clave, long long valor) {
+        if (!activo || evento.numArgumentos == MAX_ARGUMENTOS_TRAZA) return;
+        evento.claves[evento.numArgumentos] = clave;
+        evento.valores[evento.numArgumentos] = valor;
+        evento.numArgumentos++;
+    }
+
+    AmbitoTraza(const AmbitoTraza&) = delete;
+    AmbitoTraza& operator=(const AmbitoTraza&) = delete;
+
+private:
+    bool activo;
+    EventoTraza evento;
+};
+
+#endif // TRAZA_H
@@ -1,8 +1,44 @@
 #include "validacion.h"
+#include <atomic>
+#include <bitset>
 #include <iostream>
+#include <cstdint>
+#include <cstring>
+
+#include "operaciones_paralelas.h"
+#include "registro.h"
+#include "traza.h"
 
 using namespace std;
 
+// Bytes de la ventana de una semilla: la máscara recortada al final de la imagen
+static long long longitudVentana(long long semilla, long long totalBytes, long long maskSize) {
+    if (semilla < 0 || semilla >= totalBytes) return 0;
+    return totalBytes - semilla < maskSize ? totalBytes - semilla : maskSize;
+}
+
+// Compara la ventana (transformada con `operacion`, o tal cual si es 0) más la máscara con los datos esperados
+static bool validarVentana(const unsigned char* ventana, const unsigned char* imVentana, const unsigned char* mask, const unsigned int* datosMascara, long long semilla, long long longitud, int operacion) {
+    REGISTRO_DEPURACION << "Validando suma mascara...\n"
+                        << "Posicion inicial: " << semilla << '\n'
+                        << "Dimension de la mascara: " << longitud << '\n';
+
+    for (long long k = 0; k < longitud; k++) {
+        unsigned char valor = ventana[k];
+        if (operacion != 0) valor = AplicarOperacionByte(valor, imVentana ? imVentana[k] : 0, operacion);
+        unsigned int suma = valor + mask[k];
+
+        if (suma != datosMascara[k]) {
+            REGISTRO_DEPURACION << "Error en posicion " << k << ": esperado " << datosMascara[k]
+                                << ", obtenido " << suma << '\n';
+            return false;
+        }
+    }
+
+    REGISTRO_DEPURACION << "Validacion exitosa!\n";
+    return true;
+}
+
 /**
  * @brief Valida si una imagen transformada es el resultado de aplicar una suma modular con una máscara.
  *
@@ -20,29 +56,294 @@ using namespace std;
  * @return false Si hay alguna discrepancia.
  */
 
-bool ValidarSumaMascara(unsigned char* imgTransformada, unsigned char* mask, unsigned int* datosMascara, int semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto) {
+bool ValidarSumaMascara(const unsigned char* imgTransformada, const unsigned char* mask, const unsigned int* datosMascara, long long semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto) {
     if (!imgTransformada || !mask || !datosMascara) return false;
+    AmbitoTraza traza("deteccion", "ValidarSumaMascara", (long long)mask_ancho * mask_alto * 3);
 
-    int maskSize = mask_ancho * mask_alto * 3;
-    int totalPixels = anchoIMG * altoIMG * 3;
-    int pos = semilla;
+    long long longitud = longitudVentana(semilla, (long long)anchoIMG * altoIMG * 3, (long long)mask_ancho * mask_alto * 3);
+    return validarVentana(imgTransformada + (longitud > 0 ? semilla : 0), nullptr, mask, datosMascara, semilla, longitud, 0);
+}
 
-    cout << "Validando suma mascara..." << endl;
-    cout << "Posicion inicial: " << pos << endl;
-    cout << "Dimension de la mascara: " << maskSize << endl;
+/**
+ * @brief Versión de `ValidarSumaMascara` sobre vistas.
+ *
+ * Solo lee la ventana de la semilla (`img.ventana(semilla, mask.bytes())`); `img` y
+ * `mask` deben ser contiguas.
+ */
 
-    for (int k = 0; k < maskSize && pos + k < totalPixels; k++) {
-        unsigned int suma = imgTransformada[pos + k] + mask[k];
+bool ValidarSumaMascara(const VistaLectura& img, const VistaLectura& mask, const unsigned int* datosMascara, long long semilla) {
+    if (img.vacia() || !img.contigua() || mask.vacia() || !mask.contigua() || !datosMascara) return false;
+    AmbitoTraza traza("deteccion", "ValidarSumaMascara", (long long)mask.bytes());
 
-        if (suma != datosMascara[k]) {
-            cout << "Error en posicion " << k << ": esperado " << datosMascara[k]
-                 << ", obtenido " << suma << endl;
-            return false;
+    VistaLectura ventana = img.ventana((size_t)(semilla < 0 ? 0 : semilla), mask.bytes());
+    return validarVentana(ventana.datos, nullptr, mask.datos, datosMascara, semilla, ventana.vacia() ? 0 : ventana.ancho, 0);
+}
+
+/**
+ * @brief Valida una operacion inversa candidata transformando solo la ventana de la semilla.
+ *
+ * Equivale a aplicar la operacion sobre la imagen completa y llamar a `ValidarSumaMascara`,
+ * pero cada byte se transforma al momento de compararlo, de modo que el costo depende del
+ * tamaño de la máscara y no del de la imagen, y no se reserva memoria adicional.
+ *
+ * @param actualIMG Imagen actual (transformada).
+ * @param IM Imagen usada por la operación XOR (puede ser `nullptr` para rotaciones).
+ * @param mask Máscara usada para la validación.
+ * @param datosMascara Datos de enmascaramiento esperados.
+ * @param semilla Desplazamiento inicial en la imagen.
+ * @param anchoIMG Ancho de la imagen.
+ * @param altoIMG Alto de la imagen.
+ * @param mask_ancho Ancho de la máscara.
+ * @param mask_alto Alto de la máscara.
+ * @param operacion Código de la operación (1, 2X o 3X, ver `AplicarOperacionByte`).
+ * @return true Si todos los valores coinciden.
+ * @return false Si hay alguna discrepancia.
+ */
+
+bool ValidarVentanaOperacion(const unsigned char* actualIMG, const unsigned char* IM, const unsigned char* mask, const unsigned int* datosMascara, long long semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int operacion) {
+    if (!actualIMG || !mask || !datosMascara) return false;
+    if (operacion == 1 && !IM) return false;
+    AmbitoTraza traza("deteccion", "ValidarVentanaOperacion", (long long)mask_ancho * mask_alto * 3);
+    traza.argumento("operacion", operacion);
+
+    long long longitud = longitudVentana(semilla, (long long)anchoIMG * altoIMG * 3, (long long)mask_ancho * mask_alto * 3);
+    long long inicio = longitud > 0 ? semilla : 0;
+    return validarVentana(actualIMG + inicio, IM ? IM + inicio : nullptr, mask, datosMascara, semilla, longitud, operacion);
+}
+
+/**
+ * @brief Versión de `ValidarVentanaOperacion` sobre vistas.
+ *
+ * `IM` puede ser una vista vacía si la operación no es XOR. Las vistas deben ser contiguas.
+ */
+
+bool ValidarVentanaOperacion(const VistaLectura& img, const VistaLectura& IM, const VistaLectura& mask, const unsigned int* datosMascara, long long semilla, int operacion) {
+    if (img.vacia() || !img.contigua() || mask.vacia() || !mask.contigua() || !datosMascara) return false;
+    if (operacion == 1 && (IM.vacia() || !IM.contigua() || IM.bytes() != img.bytes())) return false;
+    AmbitoTraza traza("deteccion", "ValidarVentanaOperacion", (long long)mask.bytes());
+    traza.argumento("operacion", operacion);
+
+    size_t inicio = (size_t)(semilla < 0 ? 0 : semilla);
+    VistaLectura ventana = img.ventana(inicio, mask.bytes());
+    VistaLectura imVentana = IM.ventana(inicio, mask.bytes());
+    return validarVentana(ventana.datos, imVentana.datos, mask.datos, datosMascara, semilla, ventana.vacia() ? 0 : ventana.ancho, operacion);
+}
+
+/**
+ * @brief Devuelve el código de operación del candidato con el índice dado.
+ *
+ * Los candidatos se numeran en orden de prioridad:
+ * 0 → XOR, 1 → izquierda 1 bit, 2 → derecha 1 bit, 3 → izquierda 2 bits, etc.
+ *
+ * @param indice Índice del candidato (0 a NUM_CANDIDATOS - 1).
+ * @return int Código de operación (1, 2X o 3X).
+ */
+
+int CodigoCandidato(int indice) {
+    if (indice == 0) return 1;
+    int bits = (indice + 1) / 2;
+    return (indice % 2 == 1) ? 20 + bits : 30 + bits;
+}
+
+/**
+ * @brief Detecta la operación inversa recorriendo la ventana de la semilla una sola vez.
+ *
+ * Mantiene un mapa de bits con los candidatos que siguen siendo posibles (XOR y las
+ * rotaciones de 1 a MAX_BITS en ambos sentidos). Cada byte de la ventana descarta los
+ * candidatos que contradice. Si no queda ninguno se detiene; si queda uno solo, termina de
+ * verificarlo sin evaluar los demás. Entre varios supervivientes gana el de mayor prioridad,
+ * por lo que el resultado es el mismo que probar los candidatos uno por uno.
+ *
+ * @param actualIMG Imagen actual (transformada).
+ * @param IM Imagen usada por la operación XOR (si es `nullptr` se descarta XOR).
+ * @param mask Máscara usada para la validación.
+ * @param datosMascara Datos de enmascaramiento esperados.
+ * @param semilla Desplazamiento inicial en la imagen.
+ * @param anchoIMG Ancho de la imagen.
+ * @param altoIMG Alto de la imagen.
+ * @param mask_ancho Ancho de la máscara.
+ * @param mask_alto Alto de la máscara.
+ * @return int Código de la operación detectada o -1 si ningún candidato es válido.
+ *
+ * @see DetectarOperacionVentana
+ */
+
+int DetectarOperacionUnaPasada(const unsigned char* actualIMG, const unsigned char* IM, const unsigned char* mask, const unsigned int* datosMascara, long long semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto) {
+    if (!actualIMG || !mask || !datosMascara) return -1;
+
+    long long longitud = longitudVentana(semilla, (long long)anchoIMG * altoIMG * 3, (long long)mask_ancho * mask_alto * 3);
+    long long inicio = longitud > 0 ? semilla : 0;
+
+    return DetectarOperacionVentana(actualIMG + inicio, IM ? IM + inicio : nullptr, mask, datosMascara, (int)longitud);
+}
+
+/**
+ * @brief Versión de `DetectarOperacionUnaPasada` sobre vistas contiguas (`IM` vacía descarta XOR).
+ */
+
+int DetectarOperacionUnaPasada(const VistaLectura& img, const VistaLectura& IM, const VistaLectura& mask, const unsigned int* datosMascara, long long semilla) {
+    if (img.vacia() || !img.contigua() || mask.vacia() || !mask.contigua() || !datosMascara) return -1;
+
+    size_t inicio = (size_t)(semilla < 0 ? 0 : semilla);
+    VistaLectura ventana = img.ventana(inicio, mask.bytes());
+    VistaLectura imVentana = IM.contigua() ? IM.ventana(inicio, mask.bytes()) : VistaLectura();
+    return DetectarOperacionVentana(ventana.datos, imVentana.datos, mask.datos, datosMascara, ventana.vacia() ? 0 : ventana.ancho);
+}
+
+/**
+ * @brief Versión de `DetectarOperacionUnaPasada` que recibe la ventana ya recortada.
+ *
+ * @param ventana Bytes de la imagen actual a partir de la semilla.
+ * @param imVentana Bytes de IM a partir de la semilla (si es `nullptr` se descarta XOR).
+ * @param mask Máscara usada para la validación.
+ * @param datosMascara Datos de enmascaramiento esperados.
+ * @param longitud Número de bytes a comparar.
+ * @return int Código de la operación detectada o -1 si ningún candidato es válido.
+ *
+ * @see CandidatosVentana
+ */
+
+int DetectarOperacionVentana(const unsigned char* ventana, const unsigned char* imVentana, const unsigned char* mask, const unsigned int* datosMascara, int longitud) {
+    uint32_t candidatos = CandidatosVentana(ventana, imVentana, mask, datosMascara, longitud);
+    if (candidatos == 0) return -1;
+
+    int indice = 0;
+    while (!(candidatos & (1u << indice))) indice++;
+    return CodigoCandidato(indice);
+}
+
+// Ventanas de al menos `MIN_BYTES_DETECCION_PARALELA` bytes se reparten entre los hilos
+// del pool en tramos de `BYTES_TRAMO_DETECCION`. Cada byte prueba todos los candidatos,
+// así que compensa con ventanas mucho menores que en los núcleos de imagen completa.
+static const size_t BYTES_TRAMO_DETECCION = 64 * 1024;
+static const size_t MIN_BYTES_DETECCION_PARALELA = 256 * 1024;
+
+// Cada cuántos bytes un tramo publica sus candidatos y recoge los descartes de los demás
+static const int BYTES_ENTRE_CONSULTAS = 4096;
+
+// bits[r]: candidatos de rotación equivalentes a rotar r bits a la izquierda
+struct TablaRotaciones { uint32_t bits[8]; };
+
+static const TablaRotaciones& tablaRotaciones() {
+    static const TablaRotaciones tabla = [] {
+        TablaRotaciones t = {};
+        for (int i = 1; i < NUM_CANDIDATOS; i++) {
+            int codigo = CodigoCandidato(i);
+            int bits = codigo % 10;
+            int r = (codigo / 10 == 2) ? bits % 8 : (8 - bits) % 8;
+            t.bits[r] |= 1u << i;
         }
+        return t;
+    }();
+    return tabla;
+}
+
+/**
+ * @brief Candidatos de `candidatos` que reproducen los `longitud` bytes de un tramo.
+ *
+ * Si `compartidos` no es nulo, el tramo es parte de una ventana repartida entre hilos:
+ * cada `BYTES_ENTRE_CONSULTAS` bytes deja en `compartidos` solo los candidatos que
+ * sobreviven aquí y se queda con los que sobreviven en todos los tramos. Así un descarte
+ * en cualquier tramo llega a los demás, que dejan de probar ese candidato y se detienen
+ * (cancelación) cuando ya no queda ninguno.
+ */
+static uint32_t candidatosTramo(const unsigned char* ventana, const unsigned char* imVentana, const unsigned char* mask,
+                                const unsigned int* datosMascara, int longitud, uint32_t candidatos,
+                                atomic<uint32_t>* compartidos, int* bytesHastaUnico) {
+    const TablaRotaciones& habilitados = tablaRotaciones();
+
+    int k = 0;
+    while (k < longitud && candidatos != 0) {
+        int fin = (compartidos && longitud - k > BYTES_ENTRE_CONSULTAS) ? k + BYTES_ENTRE_CONSULTAS : longitud;
+
+        if (candidatos & (candidatos - 1)) {
+            for (; k < fin; k++) {
+                int objetivo = (int)datosMascara[k] - mask[k];
+                if (objetivo < 0 || objetivo > 255) {
+                    candidatos = 0;
+                    break;
+                }
+
+                unsigned char valor = ventana[k];
+                uint32_t permitidos = 0;
+                if (imVentana && (valor ^ imVentana[k]) == objetivo) permitidos |= 1u;
+                for (int r = 0; r < 8; r++) {
+                    unsigned char rotado = (unsigned char)((valor << r) | (valor >> ((8 - r) & 7)));
+                    if (rotado == objetivo) permitidos |= habilitados.bits[r];
+                }
+
+                candidatos &= permitidos;
+                if (candidatos == 0) break;
+                if ((candidatos & (candidatos - 1)) == 0) {
+                    if (bytesHastaUnico) *bytesHastaUnico = k;
+                    k++;
+                    break;
+                }
+            }
+        } else {
+            // Queda un solo candidato: verificar el resto del tramo solo para él
+            int indice = 0;
+            while (!(candidatos & (1u << indice))) indice++;
+            int operacion = CodigoCandidato(indice);
+
+            for (; k < fin; k++) {
+                unsigned char im = imVentana ? imVentana[k] : 0;
+                if (AplicarOperacionByte(ventana[k], im, operacion) + mask[k] != datosMascara[k]) {
+                    candidatos = 0;
+                    break;
+                }
+            }
+        }
+
+        if (compartidos) candidatos &= compartidos->fetch_and(candidatos);
     }
+    return candidatos;
+}
 
-    cout << "Validacion exitosa!" << endl;
-    return true;
+/**
+ * @brief Devuelve todos los candidatos que reproducen la ventana completa.
+ *
+ * Evalúa los NUM_CANDIDATOS a la vez: el bit `i` del resultado indica que el candidato
+ * `CodigoCandidato(i)` es válido. Cuando solo queda un candidato, el resto de la ventana
+ * se verifica solo para él.
+ *
+ * Las ventanas grandes se reparten en tramos entre los hilos del pool, que comparten los
+ * candidatos que siguen vivos: lo que descarta un tramo deja de probarse en los demás y
+ * todos se detienen en cuanto no queda ninguno. Un candidato es válido si lo es en todos
+ * los tramos, así que el resultado es el mismo que recorriendo la ventana en orden.
+ *
+ * @param ventana Bytes de la imagen actual a partir de la semilla.
+ * @param imVentana Bytes de IM a partir de la semilla (si es `nullptr` se descarta XOR).
+ * @param mask Máscara usada para la validación.
+ * @param datosMascara Datos de enmascaramiento esperados.
+ * @param longitud Número de bytes a comparar.
+ * @return uint32_t Máscara de bits de los candidatos válidos (0 si ninguno lo es).
+ */
+
+uint32_t CandidatosVentana(const unsigned char* ventana, const unsigned char* imVentana, const unsigned char* mask, const unsigned int* datosMascara, int longitud) {
+    if (!ventana || !mask || !datosMascara) return 0;
+    AmbitoTraza traza("deteccion", "CandidatosVentana", longitud);
+
+    uint32_t candidatos = (1u << NUM_CANDIDATOS) - 1;
+    if (!imVentana) candidatos &= ~1u;
+
+    if ((size_t)longitud < MIN_BYTES_DETECCION_PARALELA) {
+        int bytesHastaUnico = longitud;
+        candidatos = candidatosTramo(ventana, imVentana, mask, datosMascara, longitud, candidatos, nullptr, &bytesHastaUnico);
+        traza.argumento("bytes_hasta_candidato_unico", bytesHastaUnico);
+    } else {
+        atomic<uint32_t> compartidos(candidatos);
+        RepartirEnBandas((size_t)longitud, [&](size_t inicio, size_t n) {
+            uint32_t vivos = compartidos.load();
+            if (vivos == 0) return; // otro tramo ya descarto todos los candidatos
+            candidatosTramo(ventana + inicio, imVentana ? imVentana + inicio : nullptr, mask + inicio,
+                            datosMascara + inicio, (int)n, vivos, &compartidos, nullptr);
+        }, BYTES_TRAMO_DETECCION, MIN_BYTES_DETECCION_PARALELA);
+        candidatos = compartidos.load();
+    }
+
+    traza.argumento("candidatos", (long long)bitset<32>(candidatos).count());
+    return candidatos;
 }
 
 /**
@@ -63,12 +364,9 @@ bool ValidarSumaMascara(unsigned char* imgTransformada, unsigned char* mask, uns
  * @return false Si falla la validación.
  */
 
-bool validarXOR(unsigned char* actualIMG, unsigned char* IM, unsigned char* mask, unsigned int* datosMascara, int semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto) {
+bool validarXOR(const unsigned char* actualIMG, const unsigned char* IM, const unsigned char* mask, const unsigned int* datosMascara, long long semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto) {
 
-    unsigned char* xorResult = DoXOR(actualIMG, IM, anchoIMG, altoIMG);
-    bool esValido = ValidarSumaMascara(xorResult, mask, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto);
-    delete[] xorResult;
-    return esValido;
+    return ValidarVentanaOperacion(actualIMG, IM, mask, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto, 1);
 }
 
 /**
@@ -87,13 +385,9 @@ bool validarXOR(unsigned char* actualIMG, unsigned char* IM, unsigned char* mask
  * @return false En caso contrario.
  */
 
-bool validarRotarIzquierda(unsigned char* actualIMG, unsigned char* mask, unsigned int* datosMascara, int semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int bits) {
+bool validarRotarIzquierda(const unsigned char* actualIMG, const unsigned char* mask, const unsigned int* datosMascara, long long semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int bits) {
 
-    int totalPixeles = anchoIMG * altoIMG;
-    unsigned char* rotado = RotarIzquierda(actualIMG, totalPixeles, bits);
-    bool esValido = ValidarSumaMascara(rotado, mask, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto);
-    delete[] rotado;
-    return esValido;
+    return ValidarVentanaOperacion(actualIMG, nullptr, mask, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto, 20 + bits);
 }
 
 /**
@@ -112,11 +406,91 @@ bool validarRotarIzquierda(unsigned char* actualIMG, unsigned char* mask, unsign
  * @return false En caso contrario.
  */
 
-bool validarRotarDerecha(unsigned char* actualIMG, unsigned char* mask, unsigned int* datosMascara, int semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int bits) {
+bool validarRotarDerecha(const unsigned char* actualIMG, const unsigned char* mask, const unsigned int* datosMascara, long long semilla, int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int bits) {
+
+    return ValidarVentanaOperacion(actualIMG, nullptr, mask, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto, 30 + bits);
+}
+
+CalculoDigesto::CalculoDigesto() : numPendiente(0), totalBytes(0) {
+    for (int i = 0; i < NUM_ACUMULADORES_DIGESTO; i++) acumuladores[i] = 0;
+}
+
+/**
+ * @brief Agrega `n` bytes al digesto. Las franjas completas se procesan con los nucleos SIMD.
+ */
+void CalculoDigesto::agregar(const unsigned char* datos, size_t n) {
+    const KernelsOperaciones& kernels = KernelsActivos();
+    // Posicion en la entrada de la franja pendiente (o de la siguiente, si no hay)
+    uint64_t franja = (totalBytes - numPendiente) / BYTES_FRANJA_DIGESTO;
+    totalBytes += n;
+
+    if (numPendiente > 0) {
+        size_t faltan = BYTES_FRANJA_DIGESTO - numPendiente;
+        size_t copiar = n < faltan ? n : faltan;
+        memcpy(pendiente + numPendiente, datos, copiar);
+        numPendiente += copiar;
+        datos += copiar;
+        n -= copiar;
+        if (numPendiente < BYTES_FRANJA_DIGESTO) return;
+        kernels.acumularDigesto(acumuladores, pendiente, 1, franja);
+        numPendiente = 0;
+        franja++;
+    }
 
-    int totalPixeles = anchoIMG * altoIMG;
-    unsigned char* rotado = RotarDerecha(actualIMG, totalPixeles, bits);
-    bool esValido = ValidarSumaMascara(rotado, mask, datosMascara, semilla, anchoIMG, altoIMG, mask_ancho, mask_alto);
-    delete[] rotado;
-    return esValido;
+    size_t numFranjas = n / BYTES_FRANJA_DIGESTO;
+    kernels.acumularDigesto(acumuladores, datos, numFranjas, franja);
+    numPendiente = n - numFranjas * BYTES_FRANJA_DIGESTO;
+    memcpy(pendiente, datos + numFranjas * BYTES_FRANJA_DIGESTO, numPendiente);
+}
+
+/**
+ * @brief Digesto de todo lo agregado: la ultima franja se completa con ceros y los
+ * acumuladores se combinan con la longitud total.
+ */
+uint64_t CalculoDigesto::valor() const {
+    uint64_t acc[NUM_ACUMULADORES_DIGESTO];
+    for (int i = 0; i < NUM_ACUMULADORES_DIGESTO; i++) acc[i] = acumuladores[i];
+    if (numPendiente > 0) {
+        unsigned char franja[BYTES_FRANJA_DIGESTO] = {};
+        memcpy(franja, pendiente, numPendiente);
+        KernelsActivos().acumularDigesto(acc, franja, 1, totalBytes / BYTES_FRANJA_DIGESTO);
+    }
+
+    uint64_t h = totalBytes * 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < NUM_ACUMULADORES_DIGESTO; i++) {
+        h ^= acc[i] + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+    }
+
+    // Mezcla final de splitmix64: cada bit de entrada afecta a todos los de salida
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return h;
+}
+
+/**
+ * @brief Digesto de 64 bits de un bloque de bytes (ver `CalculoDigesto`).
+ */
+uint64_t DigestoBytes(const unsigned char* datos, size_t n) {
+    AmbitoTraza traza("validacion", "DigestoBytes", (long long)n);
+    CalculoDigesto digesto;
+    digesto.agregar(datos, n);
+    return digesto.valor();
+}
+
+/**
+ * @brief Compara un tramo de la imagen reconstruida con el mismo tramo de la original.
+ *
+ * Se puede llamar por partes: `desplazamiento` es la posicion del tramo en la imagen y
+ * los bytes distintos se suman a los que ya tenga `resultado`.
+ */
+void CompararBytes(const unsigned char* reconstruida, const unsigned char* original, size_t n, long long desplazamiento, VerificacionReconstruccion& resultado) {
+    size_t primera = 0;
+    size_t distintos = KernelsActivos().contarDiferencias(reconstruida, original, n, &primera);
+    if (distintos > 0 && resultado.primeraDiferencia < 0) {
+        resultado.primeraDiferencia = desplazamiento + (long long)primera;
+    }
+    resultado.bytesDistintos += (long long)distintos;
 }
@@ -1,19 +1,80 @@
 #ifndef VALIDACION_H
 #define VALIDACION_H
 
+#include <cstdint>
+
+#include "imagen.h"
 #include "operaciones.h"
+#include "operaciones_simd.h"
+
+// XOR mas las rotaciones izquierda/derecha de 1 a MAX_BITS bits
+const int NUM_CANDIDATOS = 1 + 2 * MAX_BITS;
 
-bool ValidarSumaMascara(unsigned char* imgTransformada, unsigned char* mask,
-                        unsigned int* datosMascara, int semilla,
+bool ValidarSumaMascara(const unsigned char* imgTransformada, const unsigned char* mask,
+                        const unsigned int* datosMascara, long long semilla,
                         int anchoIMG, int altoIMG, int mask_ancho, int mask_alto);
-bool validarXOR(unsigned char* actualIMG, unsigned char* IM, unsigned char* mask,
-                unsigned int* datosMascara, int semilla,
+bool ValidarVentanaOperacion(const unsigned char* actualIMG, const unsigned char* IM, const unsigned char* mask,
+                             const unsigned int* datosMascara, long long semilla,
+                             int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int operacion);
+int CodigoCandidato(int indice);
+int DetectarOperacionUnaPasada(const unsigned char* actualIMG, const unsigned char* IM, const unsigned char* mask,
+                               const unsigned int* datosMascara, long long semilla,
+                               int anchoIMG, int altoIMG, int mask_ancho, int mask_alto);
+int DetectarOperacionVentana(const unsigned char* ventana, const unsigned char* imVentana,
+                             const unsigned char* mask, const unsigned int* datosMascara, int longitud);
+uint32_t CandidatosVentana(const unsigned char* ventana, const unsigned char* imVentana,
+                           const unsigned char* mask, const unsigned int* datosMascara, int longitud);
+bool validarXOR(const unsigned char* actualIMG, const unsigned char* IM, const unsigned char* mask,
+                const unsigned int* datosMascara, long long semilla,
                 int anchoIMG, int altoIMG, int mask_ancho, int mask_alto);
-bool validarRotarIzquierda(unsigned char* actualIMG, unsigned char* mask,
-                           unsigned int* datosMascara, int semilla,
+bool validarRotarIzquierda(const unsigned char* actualIMG, const unsigned char* mask,
+                           const unsigned int* datosMascara, long long semilla,
                            int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int bits);
-bool validarRotarDerecha(unsigned char* actualIMG, unsigned char* mask,
-                         unsigned int* datosMascara, int semilla,
+bool validarRotarDerecha(const unsigned char* actualIMG, const unsigned char* mask,
+                         const unsigned int* datosMascara, long long semilla,
                          int anchoIMG, int altoIMG, int mask_ancho, int mask_alto, int bits);
 
+/**
+ * Digesto de 64 bits que se calcula por partes (por ejemplo, banda por banda): el
+ * resultado depende de los bytes agregados y de su posicion, pero no de como se
+ * dividieron. No es
+ * criptografico; sirve para comparar imagenes e informarlas en el resumen.
+ */
+class CalculoDigesto {
+public:
+    CalculoDigesto();
+    void agregar(const unsigned char* datos, size_t n);
+    uint64_t valor() const;
+
+private:
+    uint64_t acumuladores[NUM_ACUMULADORES_DIGESTO];
+    unsigned char pendiente[BYTES_FRANJA_DIGESTO];  // franja incompleta del ultimo `agregar`
+    size_t numPendiente;
+    unsigned long long totalBytes;
+};
+
+uint64_t DigestoBytes(const unsigned char* datos, size_t n);
+
+// Resultado de comparar la imagen reconstruida con la original en memoria
+struct VerificacionReconstruccion {
+    long long totalBytes = 0;
+    uint64_t digestoReconstruida = 0;
+    bool hayOriginal = false;          // I_O.bmp disponible y con las mismas dimensiones
+    uint64_t digestoOriginal = 0;
+    long long primeraDiferencia = -1;  // -1: no hay bytes distintos
+    long long bytesDistintos = 0;
+    int validacionM0 = -1;             // -1: sin M0.txt, 0: no la cumple, 1: la cumple
+
+    bool correcta() const { return bytesDistintos == 0 && validacionM0 != 0; }
+};
+
+void CompararBytes(const unsigned char* reconstruida, const unsigned char* original, size_t n, long long desplazamiento, VerificacionReconstruccion& resultado);
+
+// Variantes sobre vistas contiguas: solo se lee la ventana de la semilla
+bool ValidarSumaMascara(const VistaLectura& img, const VistaLectura& mask, const unsigned int* datosMascara, long long semilla);
+bool ValidarVentanaOperacion(const VistaLectura& img, const VistaLectura& IM, const VistaLectura& mask,
+                             const unsigned int* datosMascara, long long semilla, int operacion);
+int DetectarOperacionUnaPasada(const VistaLectura& img, const VistaLectura& IM, const VistaLectura& mask,
+                               const unsigned int* datosMascara, long long semilla);
+
 #endif // VALIDACION_H